@@ -1,842 +1,1952 @@
-#include "raylib.h"
-#include "pv_gui.h"
-
-#include <atomic>
-#include <chrono>
-#include <thread>
-
-#define MAX 2500
-#define DELAY 10
-
-struct Node
-{
-    int index;
-    int parentIndex;
-    int distance;
-};
-
-struct MinHeap
-{
-    int size;
-    Node elements[MAX];
-
-    void Insert(Node n);
-    Node ExtractMin();
-    void DecreasePriority(Node n, int priority);
-    void MinHeapify(int index);
-    bool Find(int gridIndex);
-    bool IsEmpty();
-    int Parent(int index);
-    int LeftChild(int index);
-    int RightChild(int index);
-    void Swap(Node *x, Node *y);
-};
-
-int MinHeap::Parent(int index)
-{
-    return (index - 1) / 2;
-}
-
-int MinHeap::LeftChild(int index)
-{
-    return (2 * index) + 1;
-}
-
-int MinHeap::RightChild(int index)
-{
-    return (2 * index) + 2;
-}
-
-void MinHeap::Swap(Node *x, Node *y)
-{
-    Node temp = *x;
-    *x = *y;
-    *y = temp;
-}
-
-void MinHeap::DecreasePriority(Node n, int priority)
-{
-    int index = 0;
-    for (int i = 0; i < size; i++)
-    {
-        if (elements[i].index == n.index)
-        {
-            index = i;
-            elements[i].distance = priority;
-        }
-    }
-
-    while (index != 0 && elements[Parent(index)].distance > elements[index].distance)
-    {
-        Swap(&elements[index], &elements[Parent(index)]);
-        index = Parent(index);
-    }
-}
-
-void MinHeap::MinHeapify(int index)
-{
-    bool done = false;
-
-    while (!done)
-    {
-        int left = LeftChild(index);
-        int right = RightChild(index);
-        int smallest = index;
-
-        if (left < size && elements[left].distance < elements[smallest].distance)
-        {
-            smallest = left;
-        }
-        if (right < size && elements[right].distance < elements[smallest].distance)
-        {
-            smallest = right;
-        }
-
-        if (smallest != index)
-        {
-            Swap(&elements[index], &elements[smallest]);
-            index = smallest;
-        }
-        else
-        {
-            done = true;
-        }
-    }
-}
-
-Node MinHeap::ExtractMin()
-{
-    if (size == 1)
-    {
-        size--;
-        return elements[0];
-    }
-
-    Node root = elements[0];
-    elements[0] = elements[size - 1];
-    size--;
-    MinHeapify(0);
-
-    return root;
-}
-
-bool MinHeap::Find(int gridIndex)
-{
-    for (int i = 0; i < size; i++)
-    {
-        if (elements[i].index == gridIndex)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
-void MinHeap::Insert(Node n)
-{
-    size++;
-    int index = size - 1;
-    elements[index] = n;
-
-    while (index != 0 && elements[Parent(index)].distance > elements[index].distance)
-    {
-        Swap(&elements[index], &elements[Parent(index)]);
-        index = Parent(index);
-    }
-}
-
-bool MinHeap::IsEmpty()
-{
-    return (size < 1);
-}
-
-struct Stack
-{
-    int top = 0;
-    Node elements[MAX];
-
-    Node Pop();
-    bool Push(Node item);
-    bool IsEmpty();
-    void RemoveAtIndex(int index);
-};
-
-Node Stack::Pop()
-{
-    return elements[top--];
-}
-
-bool Stack::Push(Node item)
-{
-    if (top >= (MAX - 1))
-    {
-        return false;
-    }
-    else
-    {
-        elements[++top] = item;
-        return true;
-    }
-}
-
-bool Stack::IsEmpty()
-{
-    return (top < 0);
-}
-
-void Stack::RemoveAtIndex(int index)
-{
-    Stack temp = {-1};
-
-    while (!IsEmpty())
-    {
-        if (top != index)
-        {
-            temp.Push(Pop());
-        }
-        else
-        {
-            Pop();
-        }
-    }
-
-    while (!temp.IsEmpty())
-    {
-        Push(temp.Pop());
-    }
-}
-
-struct Queue
-{
-    int size;
-    int front;
-    int rear;
-    Node elements[MAX];
-
-    Node Pop();
-    bool Push(Node item);
-    bool IsEmpty();
-};
-
-Node Queue::Pop()
-{
-    size--;
-    return elements[++front];
-}
-
-bool Queue::Push(Node item)
-{
-    if (size >= MAX)
-    {
-        return false;
-    }
-    else
-    {
-        elements[++rear] = item;
-        size++;
-        return true;
-    }
-}
-
-bool Queue::IsEmpty()
-{
-    return (size == 0);
-}
-
-struct Coordinates
-{
-    int x;
-    int y;
-};
-
-bool operator==(Color c1, Color c2)
-{
-    return c1.r == c2.r && c1.g == c2.g && c1.b == c2.b;
-}
-
-bool operator!=(Color c1, Color c2)
-{
-    return !(c1 == c2);
-}
-
-int Absolute(int i)
-{
-    return i < 0 ? -i : i;
-}
-
-int ManhattanDistance(Coordinates a, Coordinates b)
-{
-    return (Absolute(a.x - b.x) + Absolute(a.y - b.y));
-}
-
-Coordinates IndexToGridIndexes(int index, int cols)
-{
-    int x = index % cols;
-    int y = index / cols;
-    Coordinates gridIndexes = {x, y};
-
-    return gridIndexes;
-}
-
-int GridIndexesToIndex(Coordinates gridIndexes, int cols)
-{
-    return (gridIndexes.y * cols) + gridIndexes.x;
-}
-
-void GetNeighbourIndexes(int index, int cols, int rows, int *array)
-{
-    Coordinates gridIndexes = IndexToGridIndexes(index, cols);
-    Coordinates neighbour;
-
-    // Up
-    if (gridIndexes.y > 0)
-    {
-        neighbour.x = gridIndexes.x;
-        neighbour.y = gridIndexes.y - 1;
-        index = GridIndexesToIndex(neighbour, cols);
-
-        array[0] = index;
-    }
-    // Left
-    if (gridIndexes.x > 0)
-    {
-        neighbour.x = gridIndexes.x - 1;
-        neighbour.y = gridIndexes.y;
-        index = GridIndexesToIndex(neighbour, cols);
-
-        array[1] = index;
-    }
-    // Down
-    if (gridIndexes.y < rows - 1)
-    {
-        neighbour.x = gridIndexes.x;
-        neighbour.y = gridIndexes.y + 1;
-        index = GridIndexesToIndex(neighbour, cols);
-
-        array[2] = index;
-    }
-    // Right
-    if (gridIndexes.x < cols - 1)
-    {
-        neighbour.x = gridIndexes.x + 1;
-        neighbour.y = gridIndexes.y;
-        index = GridIndexesToIndex(neighbour, cols);
-
-        array[3] = index;
-    }
-}
-
-void DepthFirstSearch(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done)
-{
-    Node start = {startIndex, -1};
-    Stack stack;
-    Node visited[MAX];
-    bool solved = false;
-
-    stack.Push(start);
-    visited[startIndex] = start;
-    cells[startIndex].color = SKYBLUE;
-
-    while (!stack.IsEmpty())
-    {
-        Node current = stack.Pop();
-
-        int indexes[4] = {-1, -1, -1, -1};
-
-        GetNeighbourIndexes(current.index, cols, rows, indexes);
-
-        for (int i = 0; i < 4; i++)
-        {
-            if (indexes[i] != -1 && cells[indexes[i]].color != BEIGE && cells[indexes[i]].color != SKYBLUE)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[indexes[i]].color = SKYBLUE;
-                Node neighbour = {indexes[i], current.index};
-                visited[indexes[i]] = neighbour;
-                stack.Push(neighbour);
-                if (indexes[i] == endIndex)
-                {
-                    solved = true;
-                    break;
-                }
-            }
-        }
-
-        // Reached the end
-        if (solved)
-        {
-            // Solved path
-            current = visited[endIndex];
-            cells[current.index].color = GOLD;
-            while (current.parentIndex != -1)
-            {
-                current = visited[current.parentIndex];
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[current.index].color = GOLD;
-            }
-            break;
-        }
-    }
-    std::atomic_store(&done, true);
-}
-
-void BreadthFirstSearch(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done)
-{
-    Node start = {startIndex, -1};
-    Queue queue = {0, -1, -1};
-    Node visited[MAX];
-    bool solved = false;
-
-    queue.Push(start);
-    visited[startIndex] = start;
-    cells[startIndex].color = SKYBLUE;
-
-    while (!queue.IsEmpty())
-    {
-        Node current = queue.Pop();
-
-        int indexes[4] = {-1, -1, -1, -1};
-
-        GetNeighbourIndexes(current.index, cols, rows, indexes);
-
-        for (int i = 0; i < 4; i++)
-        {
-            if (indexes[i] != -1 && cells[indexes[i]].color != BEIGE && cells[indexes[i]].color != SKYBLUE)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[indexes[i]].color = SKYBLUE;
-                Node neighbour = {indexes[i], current.index};
-                visited[indexes[i]] = neighbour;
-                queue.Push(neighbour);
-                if (indexes[i] == endIndex)
-                {
-                    solved = true;
-                    break;
-                }
-            }
-        }
-
-        // Reached the end
-        if (solved)
-        {
-            // Solved path
-            current = visited[endIndex];
-            cells[current.index].color = GOLD;
-            while (current.parentIndex != -1)
-            {
-                current = visited[current.parentIndex];
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[current.index].color = GOLD;
-            }
-            break;
-        }
-    }
-    std::atomic_store(&done, true);
-}
-
-void Dijkstra(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done)
-{
-    Node start = {startIndex, -1, 0};
-    MinHeap minHeap = {0};
-    Node visited[MAX];
-    bool solved = false;
-
-    for (int i = 0; i < MAX; i++)
-    {
-        visited[i].distance = INT_MAX;
-        visited[i].parentIndex = -1;
-    }
-
-    minHeap.Insert(start);
-    visited[startIndex] = start;
-    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-    cells[startIndex].color = SKYBLUE;
-
-    while (!minHeap.IsEmpty())
-    {
-        Node current = minHeap.ExtractMin();
-
-        int indexes[4] = {-1, -1, -1, -1};
-        GetNeighbourIndexes(current.index, cols, rows, indexes);
-
-        for (int i = 0; i < 4; i++)
-        {
-            int neighbourIndex = indexes[i];
-            if (neighbourIndex != -1 && cells[neighbourIndex].color != BEIGE)
-            {
-                int cost = 1;
-                if (cells[neighbourIndex].weighted)
-                {
-                    cost = 10;
-                }
-                int newDistance = current.distance + cost;
-
-                if (newDistance < visited[neighbourIndex].distance)
-                {
-
-                    Node neighbour = {neighbourIndex, current.index, newDistance};
-                    visited[neighbourIndex] = neighbour;
-
-                    if (minHeap.Find(neighbourIndex))
-                    {
-                        minHeap.DecreasePriority(neighbour, newDistance);
-                    }
-                    else
-                    {
-                        minHeap.Insert(neighbour);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                        cells[neighbourIndex].color = SKYBLUE;
-                    }
-
-                    if (neighbourIndex == endIndex)
-                    {
-                        solved = true;
-                        break;
-                    }
-                }
-            }
-        }
-        // Reached the end
-        if (solved)
-        {
-            // Solved path
-            current = visited[endIndex];
-            cells[current.index].color = GOLD;
-            while (current.parentIndex != -1)
-            {
-                current = visited[current.parentIndex];
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[current.index].color = GOLD;
-            }
-            break;
-        }
-    }
-    std::atomic_store(&done, true);
-}
-
-void AStar(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done)
-{
-    Node start = {startIndex, -1, 0};
-    MinHeap minHeap = {0};
-    Node visited[MAX];
-    Node gScore[MAX];
-    Node fScore[MAX];
-    bool solved = false;
-
-    for (int i = 0; i < MAX; i++)
-    {
-        gScore[i].distance = INT_MAX;
-        fScore[i].distance = INT_MAX;
-        gScore[i].parentIndex = -1;
-        fScore[i].parentIndex = -1;
-    }
-
-    minHeap.Insert(start);
-    visited[startIndex] = start;
-    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-    cells[startIndex].color = SKYBLUE;
-
-    gScore[startIndex].distance = 0;
-    Coordinates startCoord = IndexToGridIndexes(startIndex, cols);
-    Coordinates endCoord = IndexToGridIndexes(endIndex, cols);
-    fScore[startIndex].distance = ManhattanDistance(startCoord, endCoord);
-
-    while (!minHeap.IsEmpty())
-    {
-        Node current = minHeap.ExtractMin();
-
-        int indexes[4] = {-1, -1, -1, -1};
-        GetNeighbourIndexes(current.index, cols, rows, indexes);
-
-        for (int i = 0; i < 4; i++)
-        {
-            int neighbourIndex = indexes[i];
-            if (neighbourIndex != -1 && cells[neighbourIndex].color != BEIGE)
-            {
-                int cost = 1;
-                if (cells[neighbourIndex].weighted)
-                {
-                    cost = 10;
-                }
-                int tentativeScore = gScore[current.index].distance + cost;
-
-                if (tentativeScore < gScore[neighbourIndex].distance)
-                {
-
-                    Node gNeighbour = {neighbourIndex, current.index, tentativeScore};
-                    visited[neighbourIndex] = gNeighbour;
-                    gScore[neighbourIndex] = gNeighbour;
-
-                    Coordinates start = IndexToGridIndexes(neighbourIndex, cols);
-                    Coordinates goal = IndexToGridIndexes(endIndex, cols);
-                    int estimatedCostToGoal = ManhattanDistance(start, goal);
-
-                    Node fNeighbour = {neighbourIndex, current.index, tentativeScore + estimatedCostToGoal};
-                    fScore[neighbourIndex] = fNeighbour;
-
-                    if (!minHeap.Find(neighbourIndex))
-                    {
-                        minHeap.Insert(fNeighbour);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                        cells[neighbourIndex].color = SKYBLUE;
-                    }
-
-                    if (neighbourIndex == endIndex)
-                    {
-                        solved = true;
-                        break;
-                    }
-                }
-            }
-        }
-        // Reached the end
-        if (solved)
-        {
-            // Solved path
-            current = visited[endIndex];
-            cells[current.index].color = GOLD;
-            while (current.parentIndex != -1)
-            {
-                current = visited[current.parentIndex];
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[current.index].color = GOLD;
-            }
-            break;
-        }
-    }
-    std::atomic_store(&done, true);
-}
-
-void RandomizedPrimsMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done)
-{
-    int size = rows * cols;
-
-    // Start with grid filled with walls and keep track of walls being processed
-    Stack wallList = {-1};
-
-    // Random number for start cell
-    SetRandomSeed(GetTime());
-    int randStartCell = GetRandomValue(0, size - 1);
-
-    // Mark random start cell as maze path
-    cells[randStartCell].color = RAYWHITE;
-
-    int indexes[4] = {-1, -1, -1, -1};
-
-    GetNeighbourIndexes(randStartCell, cols, rows, indexes);
-
-    for (int i = 0; i < 4; i++)
-    {
-        if (indexes[i] != -1)
-        {
-            Node wall = {indexes[i]};
-            wallList.Push(wall);
-        }
-    }
-
-    while (!wallList.IsEmpty())
-    {
-        int randomWall = GetRandomValue(0, wallList.top);
-
-        int index = wallList.elements[randomWall].index;
-        int neighbourPathCount = 0;
-
-        int indexes[4] = {-1, -1, -1, -1};
-        GetNeighbourIndexes(index, cols, rows, indexes);
-
-        for (int i = 0; i < 4; i++)
-        {
-            if (cells[indexes[i]].color == RAYWHITE)
-            {
-                neighbourPathCount++;
-                indexes[i] = -1;
-            }
-        }
-
-        if (neighbourPathCount <= 1)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-            cells[index].color = RAYWHITE;
-            for (int i = 0; i < 4; i++)
-            {
-                if (indexes[i] != -1)
-                {
-                    Node wall = {indexes[i]};
-                    wallList.Push(wall);
-                }
-            }
-        }
-
-        // Remove wall from stack
-        wallList.RemoveAtIndex(randomWall);
-    }
-
-    std::atomic_store(&done, true);
-}
-
-void RandomizedDFSMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done)
-{
-    int size = rows * cols;
-
-    // Start with grid filled with walls and keep track of walls being processed
-    Stack wallList = {-1};
-
-    // Random number for start cell
-    SetRandomSeed(GetTime());
-    int randStartCell = GetRandomValue(0, size - 1);
-
-    // Mark random start cell as maze path
-    cells[randStartCell].color = RAYWHITE;
-
-    Node randStartNode = {randStartCell};
-
-    wallList.Push(randStartNode);
-
-    while (!wallList.IsEmpty())
-    {
-        Node node = wallList.Pop();
-
-        int indexes[4] = {-1, -1, -1, -1};
-        GetNeighbourIndexes(node.index, cols, rows, indexes);
-
-        int availableNeighbours = 4;
-        for (int i = 0; i < 4; i++)
-        {
-            if (cells[indexes[i]].color == RAYWHITE || indexes[i] == -1)
-            {
-                availableNeighbours--;
-                indexes[i] = -1;
-            }
-            // Check if neighbour would create a loop
-            else
-            {
-                int neighbourIndexes[4] = {-1, -1, -1, -1};
-                GetNeighbourIndexes(indexes[i], cols, rows, neighbourIndexes);
-
-                int neighbourPathCount = 0;
-                for (int i = 0; i < 4; i++)
-                {
-                    if (cells[neighbourIndexes[i]].color == RAYWHITE)
-                    {
-                        neighbourPathCount++;
-                        neighbourIndexes[i] = -1;
-                    }
-                }
-
-                if (neighbourPathCount > 1)
-                {
-                    availableNeighbours--;
-                    indexes[i] = -1;
-                }
-            }
-        }
-
-        if (availableNeighbours > 0)
-        {
-            wallList.Push(node);
-            int randIndex = GetRandomValue(0, availableNeighbours - 1);
-            int currIndex = 0;
-            int foundIndex = 0;
-
-            for (int i = 0; i < 4; i++)
-            {
-                if (cells[indexes[i]].color != RAYWHITE && indexes[i] != -1)
-                {
-                    if (currIndex == randIndex)
-                    {
-                        foundIndex = i;
-                    }
-                    currIndex++;
-                }
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-            cells[indexes[foundIndex]].color = RAYWHITE;
-            Node wall = {indexes[foundIndex]};
-            wallList.Push(wall);
-        }
-    }
-    std::atomic_store(&done, true);
-}
-
-void SidewinderMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done)
-{
-    SetRandomSeed(GetTime());
-
-    // First row path
-    for (int i = 0; i < cols; i++)
-    {
-        cells[i].color = RAYWHITE;
-    }
-
-    for (int i = 2; i < rows; i += 2)
-    {
-        int runStartIndex = 0;
-        bool skipNext = false;
-
-        for (int j = 0; j < cols; j++)
-        {
-
-            if (!skipNext)
-            {
-                // Current cell is a path
-                Coordinates coords = {j, i};
-                int index = GridIndexesToIndex(coords, cols);
-                std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                cells[index].color = RAYWHITE;
-
-                int goEast = GetRandomValue(0, 1);
-
-                // Edge of the maze
-                if (j == cols - 1)
-                {
-                    goEast = false;
-                }
-
-                if (j + 1 >= cols || !goEast)
-                {
-                    int availableNodes[cols];
-                    int numAvailable = 0;
-
-                    for (int x = runStartIndex; x < j + 1; x++)
-                    {
-                        coords = {x, i - 2};
-                        index = GridIndexesToIndex(coords, cols);
-                        if (cells[index].color == RAYWHITE)
-                        {
-                            availableNodes[numAvailable++] = x;
-                        }
-                    }
-
-                    if (numAvailable == 0)
-                    {
-                        // Make sure edge of the maze is connected
-                        if (j == cols - 1)
-                        {
-                            coords = {j - 1, i};
-                            index = GridIndexesToIndex(coords, cols);
-                            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                            cells[index].color = RAYWHITE;
-                        }
-                        continue;
-                    }
-
-                    int randIndex = GetRandomValue(0, numAvailable - 1);
-
-                    // Path north of a cell that has been visited in this row
-                    coords = {availableNodes[randIndex], i - 1};
-                    index = GridIndexesToIndex(coords, cols);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
-                    cells[index].color = RAYWHITE;
-
-                    runStartIndex = j + 2;
-                    skipNext = true;
-                }
-            }
-            else
-            {
-                skipNext = false;
-            }
-        }
-    }
-    std::atomic_store(&done, true);
-}
+#include "pv_algorithms.h"
+#include "pv_landmarks.h"
+
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <vector>
+
+// Random engine shared by the maze generators
+static std::mt19937 randomEngine;
+
+void SetAlgorithmSeed(unsigned int seed)
+{
+    randomEngine.seed(seed);
+}
+
+// Random integer in [min, max]
+int RandomValue(int min, int max)
+{
+    std::uniform_int_distribution<int> distribution(min, max);
+    return distribution(randomEngine);
+}
+
+// Binary heap indexed by grid index so membership checks are O(1) and decrease-key is O(log n)
+struct MinHeap
+{
+    int size;
+    std::vector<Node> elements;
+    // Heap slot of each grid index, -1 when it is not in the heap
+    std::vector<int> positions;
+
+    // Takes the storage of a scratch first when given one, Release hands it back
+    void Reserve(int gridSize, QueueScratch *storage = NULL);
+    void Release(QueueScratch *storage);
+    void Insert(Node n);
+    Node ExtractMin();
+    void DecreasePriority(Node n, int priority);
+    void MinHeapify(int index);
+    void SiftUp(int index);
+    bool Find(int gridIndex);
+    bool IsEmpty();
+    int MinPriority();
+    int Parent(int index);
+    int LeftChild(int index);
+    int RightChild(int index);
+    void Swap(int x, int y);
+};
+
+int MinHeap::Parent(int index)
+{
+    return (index - 1) / 2;
+}
+
+int MinHeap::LeftChild(int index)
+{
+    return (2 * index) + 1;
+}
+
+int MinHeap::RightChild(int index)
+{
+    return (2 * index) + 2;
+}
+
+void MinHeap::Swap(int x, int y)
+{
+    Node temp = elements[x];
+    elements[x] = elements[y];
+    elements[y] = temp;
+
+    positions[elements[x].index] = x;
+    positions[elements[y].index] = y;
+}
+
+void MinHeap::Reserve(int gridSize, QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        elements.swap(storage->elements);
+        positions.swap(storage->positions);
+    }
+    size = 0;
+    positions.assign(gridSize, -1);
+}
+
+void MinHeap::Release(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        storage->elements.swap(elements);
+        storage->positions.swap(positions);
+    }
+}
+
+void MinHeap::SiftUp(int index)
+{
+    while (index != 0 && elements[Parent(index)].distance > elements[index].distance)
+    {
+        Swap(index, Parent(index));
+        index = Parent(index);
+    }
+}
+
+void MinHeap::DecreasePriority(Node n, int priority)
+{
+    int index = positions[n.index];
+
+    elements[index] = n;
+    elements[index].distance = priority;
+    SiftUp(index);
+}
+
+void MinHeap::MinHeapify(int index)
+{
+    bool done = false;
+
+    while (!done)
+    {
+        int left = LeftChild(index);
+        int right = RightChild(index);
+        int smallest = index;
+
+        if (left < size && elements[left].distance < elements[smallest].distance)
+        {
+            smallest = left;
+        }
+        if (right < size && elements[right].distance < elements[smallest].distance)
+        {
+            smallest = right;
+        }
+
+        if (smallest != index)
+        {
+            Swap(index, smallest);
+            index = smallest;
+        }
+        else
+        {
+            done = true;
+        }
+    }
+}
+
+Node MinHeap::ExtractMin()
+{
+    Node root = elements[0];
+    positions[root.index] = -1;
+    size--;
+
+    if (size > 0)
+    {
+        elements[0] = elements[size];
+        positions[elements[0].index] = 0;
+        MinHeapify(0);
+    }
+
+    return root;
+}
+
+bool MinHeap::Find(int gridIndex)
+{
+    return positions[gridIndex] != -1;
+}
+
+void MinHeap::Insert(Node n)
+{
+    // Grow the backing storage only when every slot is in use
+    if (size == (int)elements.size())
+    {
+        elements.push_back(n);
+    }
+    size++;
+    int index = size - 1;
+    elements[index] = n;
+    positions[n.index] = index;
+
+    SiftUp(index);
+}
+
+bool MinHeap::IsEmpty()
+{
+    return (size < 1);
+}
+
+int MinHeap::MinPriority()
+{
+    return elements[0].distance;
+}
+
+// Monotone bucket queue (Dial's algorithm) for small integer edge costs. Keys must stay within
+// numBuckets of the last extracted key, each bucket is a doubly linked list threaded through grid indexes
+struct BucketQueue
+{
+    int size;
+    int current;
+    std::vector<int> heads;
+    std::vector<int> next;
+    std::vector<int> prev;
+    std::vector<Node> nodes;
+    std::vector<bool> queued;
+
+    // Takes the storage of a scratch first when given one, Release hands it back
+    void Reserve(int gridSize, int numBuckets, QueueScratch *storage = NULL);
+    void Release(QueueScratch *storage);
+    void Insert(Node n);
+    Node ExtractMin();
+    void DecreasePriority(Node n, int priority);
+    bool Find(int gridIndex);
+    bool IsEmpty();
+    int MinPriority();
+    void Link(int gridIndex);
+    void Unlink(int gridIndex);
+};
+
+void BucketQueue::Reserve(int gridSize, int numBuckets, QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        heads.swap(storage->heads);
+        next.swap(storage->next);
+        prev.swap(storage->prev);
+        nodes.swap(storage->nodes);
+        queued.swap(storage->queued);
+    }
+    size = 0;
+    current = INT_MAX;
+    heads.assign(numBuckets, -1);
+    next.assign(gridSize, -1);
+    prev.assign(gridSize, -1);
+    nodes.resize(gridSize);
+    queued.assign(gridSize, false);
+}
+
+void BucketQueue::Release(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        storage->heads.swap(heads);
+        storage->next.swap(next);
+        storage->prev.swap(prev);
+        storage->nodes.swap(nodes);
+        storage->queued.swap(queued);
+    }
+}
+
+void BucketQueue::Link(int gridIndex)
+{
+    int bucket = nodes[gridIndex].distance % (int)heads.size();
+
+    prev[gridIndex] = -1;
+    next[gridIndex] = heads[bucket];
+    if (heads[bucket] != -1)
+    {
+        prev[heads[bucket]] = gridIndex;
+    }
+    heads[bucket] = gridIndex;
+    queued[gridIndex] = true;
+}
+
+void BucketQueue::Unlink(int gridIndex)
+{
+    int bucket = nodes[gridIndex].distance % (int)heads.size();
+
+    if (prev[gridIndex] != -1)
+    {
+        next[prev[gridIndex]] = next[gridIndex];
+    }
+    else
+    {
+        heads[bucket] = next[gridIndex];
+    }
+    if (next[gridIndex] != -1)
+    {
+        prev[next[gridIndex]] = prev[gridIndex];
+    }
+    queued[gridIndex] = false;
+}
+
+void BucketQueue::Insert(Node n)
+{
+    // Current is where the scan for the minimum starts, so it has to stay at or below every queued key. Keys are only
+    // monotone after an extraction, keys queued before it can arrive in any order
+    if (n.distance < current)
+    {
+        current = n.distance;
+    }
+    nodes[n.index] = n;
+    Link(n.index);
+    size++;
+}
+
+Node BucketQueue::ExtractMin()
+{
+    int numBuckets = heads.size();
+    int gridIndex = heads[MinPriority() % numBuckets];
+    Unlink(gridIndex);
+    size--;
+
+    return nodes[gridIndex];
+}
+
+// Advancing to the smallest key is safe without extracting it, later keys come from extracting it or larger keys
+int BucketQueue::MinPriority()
+{
+    int numBuckets = heads.size();
+
+    while (heads[current % numBuckets] == -1)
+    {
+        current++;
+    }
+    return current;
+}
+
+void BucketQueue::DecreasePriority(Node n, int priority)
+{
+    Unlink(n.index);
+    nodes[n.index] = n;
+    nodes[n.index].distance = priority;
+    Link(n.index);
+
+    // Same as an insert, a lowered key must not fall behind the scan
+    if (priority < current)
+    {
+        current = priority;
+    }
+}
+
+bool BucketQueue::Find(int gridIndex)
+{
+    return queued[gridIndex];
+}
+
+bool BucketQueue::IsEmpty()
+{
+    return (size < 1);
+}
+
+struct Stack
+{
+    std::vector<Node> elements;
+
+    // Takes the storage of a scratch when given one, Release hands it back
+    void Reserve(QueueScratch *storage);
+    void Release(QueueScratch *storage);
+    Node Pop();
+    void Push(Node item);
+    bool IsEmpty();
+};
+
+void Stack::Reserve(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        elements.swap(storage->elements);
+    }
+    elements.clear();
+}
+
+void Stack::Release(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        storage->elements.swap(elements);
+    }
+}
+
+Node Stack::Pop()
+{
+    Node item = elements.back();
+    elements.pop_back();
+    return item;
+}
+
+void Stack::Push(Node item)
+{
+    elements.push_back(item);
+}
+
+bool Stack::IsEmpty()
+{
+    return elements.empty();
+}
+
+// Unordered set of grid indexes with O(1) random removal, each index can only ever be added once
+struct RandomSet
+{
+    std::vector<int> elements;
+    std::vector<bool> added;
+
+    void Reserve(int gridSize);
+    void Insert(int gridIndex);
+    int RemoveAtIndex(int index);
+    bool IsEmpty();
+    int Size();
+};
+
+void RandomSet::Reserve(int gridSize)
+{
+    added.assign(gridSize, false);
+}
+
+void RandomSet::Insert(int gridIndex)
+{
+    if (!added[gridIndex])
+    {
+        added[gridIndex] = true;
+        elements.push_back(gridIndex);
+    }
+}
+
+int RandomSet::RemoveAtIndex(int index)
+{
+    // Swap with the last element and pop
+    int gridIndex = elements[index];
+    elements[index] = elements.back();
+    elements.pop_back();
+
+    return gridIndex;
+}
+
+bool RandomSet::IsEmpty()
+{
+    return elements.empty();
+}
+
+int RandomSet::Size()
+{
+    return elements.size();
+}
+
+struct Queue
+{
+    int front;
+    std::vector<Node> elements;
+
+    // Takes the storage of a scratch when given one, Release hands it back
+    void Reserve(QueueScratch *storage);
+    void Release(QueueScratch *storage);
+    Node Pop();
+    void Push(Node item);
+    bool IsEmpty();
+};
+
+void Queue::Reserve(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        elements.swap(storage->elements);
+    }
+    front = 0;
+    elements.clear();
+}
+
+void Queue::Release(QueueScratch *storage)
+{
+    if (storage != NULL)
+    {
+        storage->elements.swap(elements);
+    }
+}
+
+Node Queue::Pop()
+{
+    return elements[front++];
+}
+
+void Queue::Push(Node item)
+{
+    elements.push_back(item);
+}
+
+bool Queue::IsEmpty()
+{
+    return (front == (int)elements.size());
+}
+
+struct Coordinates
+{
+    int x;
+    int y;
+};
+
+int Absolute(int i)
+{
+    return i < 0 ? -i : i;
+}
+
+int ManhattanDistance(Coordinates a, Coordinates b)
+{
+    return (Absolute(a.x - b.x) + Absolute(a.y - b.y));
+}
+
+Coordinates IndexToGridIndexes(const Grid &grid, int index)
+{
+    Coordinates gridIndexes = {grid.X(index), grid.Y(index)};
+
+    return gridIndexes;
+}
+
+// Neighbours in the order of Grid::offsets, the sentinel border is reported as -1 so the maze generators never carve it
+void GetNeighbourIndexes(const Grid &grid, int index, int *array)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbour = index + grid.offsets[i];
+        array[i] = grid.IsBorder(neighbour) ? -1 : neighbour;
+    }
+}
+
+// Queue storage lent by the scratch for a side, NULL without a scratch
+static QueueScratch *LentQueue(SearchScratch *scratch, int side)
+{
+    return scratch != NULL ? &scratch->queues[side] : NULL;
+}
+
+SearchStepper::SearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : Stepper(events), grid(grid), startIndex(startIndex), endIndex(endIndex), result({false, 0, 0, 0}), tracing(false), traceIndex(-1), scratch(scratch)
+{
+    // Borrowed buffers keep their capacity, so a search on a grid of the same size allocates nothing for them
+    if (scratch != NULL)
+    {
+        visited.swap(scratch->visited);
+        states.swap(scratch->states);
+    }
+    visited.assign(grid.Size(), Node());
+    states.assign(grid.Size(), cellUnvisited);
+}
+
+SearchStepper::~SearchStepper()
+{
+    if (scratch != NULL)
+    {
+        scratch->visited.swap(visited);
+        scratch->states.swap(states);
+    }
+}
+
+// Event reported for each search state
+static const GridEventType stateEvents[] = {eventFrontier, eventFrontier, eventVisit, eventPath, eventFrontierReverse, eventVisitReverse};
+
+void SearchStepper::Mark(int index, CellState state)
+{
+    states[index] = state;
+    Emit(index, stateEvents[state]);
+}
+
+void SearchStepper::TracePath(std::vector<int> &path) const
+{
+    path.clear();
+
+    if (!result.found)
+    {
+        return;
+    }
+
+    for (int index = endIndex; index != -1; index = visited[index].parentIndex)
+    {
+        path.push_back(index);
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+bool SearchStepper::Step(long long steps)
+{
+    while (!finished && !cancelled && steps > 0)
+    {
+        steps--;
+
+        if (tracing)
+        {
+            // Solved path, one cell per step from the end back to the start
+            Node current = visited[traceIndex];
+            Mark(traceIndex, cellPath);
+
+            if (current.parentIndex == -1)
+            {
+                finished = true;
+            }
+            else
+            {
+                result.pathLength++;
+                result.pathCost += grid.costs[traceIndex];
+                traceIndex = current.parentIndex;
+            }
+        }
+        else if (!Expand())
+        {
+            // Reached the end
+            if (result.found)
+            {
+                tracing = true;
+                traceIndex = endIndex;
+            }
+            else
+            {
+                finished = true;
+            }
+        }
+    }
+    return finished;
+}
+
+struct DepthFirstSearchStepper : SearchStepper
+{
+    Stack stack;
+
+    DepthFirstSearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+    ~DepthFirstSearchStepper();
+
+    bool Expand() override;
+};
+
+DepthFirstSearchStepper::DepthFirstSearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch)
+{
+    Node start = {startIndex, -1};
+
+    stack.Reserve(LentQueue(scratch, 0));
+    stack.Push(start);
+    visited[startIndex] = start;
+    Mark(startIndex, cellFrontier);
+}
+
+DepthFirstSearchStepper::~DepthFirstSearchStepper()
+{
+    stack.Release(LentQueue(scratch, 0));
+}
+
+bool DepthFirstSearchStepper::Expand()
+{
+    if (stack.IsEmpty())
+    {
+        return false;
+    }
+
+    Node current = stack.Pop();
+    result.expansions++;
+    Mark(current.index, cellVisited);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = current.index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex) && states[neighbourIndex] == cellUnvisited)
+        {
+            Mark(neighbourIndex, cellFrontier);
+            Node neighbour = {neighbourIndex, current.index};
+            visited[neighbourIndex] = neighbour;
+            stack.Push(neighbour);
+            if (neighbourIndex == endIndex)
+            {
+                result.found = true;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct BreadthFirstSearchStepper : SearchStepper
+{
+    Queue queue = {0};
+
+    BreadthFirstSearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+    ~BreadthFirstSearchStepper();
+
+    bool Expand() override;
+};
+
+BreadthFirstSearchStepper::BreadthFirstSearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch)
+{
+    Node start = {startIndex, -1};
+
+    queue.Reserve(LentQueue(scratch, 0));
+    queue.Push(start);
+    visited[startIndex] = start;
+    Mark(startIndex, cellFrontier);
+}
+
+BreadthFirstSearchStepper::~BreadthFirstSearchStepper()
+{
+    queue.Release(LentQueue(scratch, 0));
+}
+
+bool BreadthFirstSearchStepper::Expand()
+{
+    if (queue.IsEmpty())
+    {
+        return false;
+    }
+
+    Node current = queue.Pop();
+    result.expansions++;
+    Mark(current.index, cellVisited);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = current.index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex) && states[neighbourIndex] == cellUnvisited)
+        {
+            Mark(neighbourIndex, cellFrontier);
+            Node neighbour = {neighbourIndex, current.index};
+            visited[neighbourIndex] = neighbour;
+            queue.Push(neighbour);
+            if (neighbourIndex == endIndex)
+            {
+                result.found = true;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Buckets needed to hold every key reachable from the current minimum, A* keys can grow by one more
+// than the edge cost because the Manhattan estimate changes by at most one per step
+int BucketCount(int maxCost, bool heuristic)
+{
+    return heuristic ? maxCost + 2 : maxCost + 1;
+}
+
+// Consistent bounds change by at most the cost of the move back, so keys grow by up to twice the largest cost
+int LandmarkBucketCount(int maxCost)
+{
+    return 2 * maxCost + 1;
+}
+
+// Bidirectional keys are doubled, and with potentials change by at most two more than twice the edge cost
+int BidirectionalBucketCount(int maxCost, bool heuristic)
+{
+    return heuristic ? 2 * maxCost + 3 : 2 * maxCost + 1;
+}
+
+bool UseBucketQueue(QueueBackend backend, int maxCost)
+{
+    if (backend == queueAuto)
+    {
+        return maxCost <= BUCKET_QUEUE_MAX_COST;
+    }
+    return backend == queueBucket;
+}
+
+template <typename PriorityQueue>
+struct DijkstraStepper : SearchStepper
+{
+    PriorityQueue minHeap;
+
+    DijkstraStepper(const Grid &grid, int startIndex, int endIndex, PriorityQueue &&queue, EventRing *events, SearchScratch *scratch);
+    ~DijkstraStepper();
+
+    bool Expand() override;
+};
+
+template <typename PriorityQueue>
+DijkstraStepper<PriorityQueue>::DijkstraStepper(const Grid &grid, int startIndex, int endIndex, PriorityQueue &&queue, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch), minHeap(std::move(queue))
+{
+    Node start = {startIndex, -1, 0};
+
+    for (int i = 0; i < grid.Size(); i++)
+    {
+        visited[i].distance = INT_MAX;
+        visited[i].parentIndex = -1;
+    }
+
+    minHeap.Insert(start);
+    visited[startIndex] = start;
+    Mark(startIndex, cellFrontier);
+}
+
+template <typename PriorityQueue>
+DijkstraStepper<PriorityQueue>::~DijkstraStepper()
+{
+    minHeap.Release(LentQueue(scratch, 0));
+}
+
+template <typename PriorityQueue>
+bool DijkstraStepper<PriorityQueue>::Expand()
+{
+    if (minHeap.IsEmpty())
+    {
+        return false;
+    }
+
+    Node current = minHeap.ExtractMin();
+    result.expansions++;
+    Mark(current.index, cellVisited);
+
+    // Weighted cells can still lower the end's distance after it is first reached, it is final once extracted
+    if (current.index == endIndex)
+    {
+        result.found = true;
+        return false;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = current.index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex))
+        {
+            int cost = grid.costs[neighbourIndex];
+            int newDistance = current.distance + cost;
+
+            if (newDistance < visited[neighbourIndex].distance)
+            {
+                Node neighbour = {neighbourIndex, current.index, newDistance};
+                visited[neighbourIndex] = neighbour;
+
+                if (minHeap.Find(neighbourIndex))
+                {
+                    minHeap.DecreasePriority(neighbour, newDistance);
+                }
+                else
+                {
+                    minHeap.Insert(neighbour);
+                    Mark(neighbourIndex, cellFrontier);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Manhattan distance to the end, every move costs at least one
+struct ManhattanHeuristic
+{
+    Coordinates endCoord;
+
+    ManhattanHeuristic(const Grid &grid, int endIndex) : endCoord(IndexToGridIndexes(grid, endIndex)) {}
+
+    int operator()(const Grid &grid, int index) const
+    {
+        return ManhattanDistance(IndexToGridIndexes(grid, index), endCoord);
+    }
+};
+
+// ALT bound from a landmark table, never below the Manhattan distance. The maximum of consistent bounds is consistent
+struct LandmarkHeuristic
+{
+    const LandmarkTable &table;
+    int endIndex;
+    ManhattanHeuristic manhattan;
+    int32_t endDistances[LANDMARK_MAX_COUNT];
+
+    LandmarkHeuristic(const LandmarkTable &table, const Grid &grid, int endIndex) : table(table), endIndex(endIndex), manhattan(grid, endIndex)
+    {
+        std::copy(table.Distances(endIndex), table.Distances(endIndex) + table.count, endDistances);
+    }
+
+    int operator()(const Grid &grid, int index) const
+    {
+        return std::max(manhattan(grid, index), table.Estimate(grid, index, endIndex, endDistances));
+    }
+};
+
+// Keeps the g score of every cell in visited and queues cells by f score
+template <typename PriorityQueue, typename Heuristic>
+struct AStarStepper : SearchStepper
+{
+    PriorityQueue minHeap;
+    Heuristic heuristic;
+
+    AStarStepper(const Grid &grid, int startIndex, int endIndex, PriorityQueue &&queue, Heuristic heuristic, EventRing *events, SearchScratch *scratch);
+    ~AStarStepper();
+
+    bool Expand() override;
+};
+
+template <typename PriorityQueue, typename Heuristic>
+AStarStepper<PriorityQueue, Heuristic>::AStarStepper(const Grid &grid, int startIndex, int endIndex, PriorityQueue &&queue, Heuristic heuristic, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch), minHeap(std::move(queue)), heuristic(heuristic)
+{
+    for (int i = 0; i < grid.Size(); i++)
+    {
+        visited[i].distance = INT_MAX;
+        visited[i].parentIndex = -1;
+    }
+
+    Node start = {startIndex, -1, heuristic(grid, startIndex)};
+
+    minHeap.Insert(start);
+    visited[startIndex] = {startIndex, -1, 0};
+    Mark(startIndex, cellFrontier);
+}
+
+template <typename PriorityQueue, typename Heuristic>
+AStarStepper<PriorityQueue, Heuristic>::~AStarStepper()
+{
+    minHeap.Release(LentQueue(scratch, 0));
+}
+
+template <typename PriorityQueue, typename Heuristic>
+bool AStarStepper<PriorityQueue, Heuristic>::Expand()
+{
+    if (minHeap.IsEmpty())
+    {
+        return false;
+    }
+
+    Node current = minHeap.ExtractMin();
+    result.expansions++;
+    Mark(current.index, cellVisited);
+
+    // Weighted cells can still lower the end's distance after it is first reached, it is final once extracted
+    if (current.index == endIndex)
+    {
+        result.found = true;
+        return false;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = current.index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex))
+        {
+            int cost = grid.costs[neighbourIndex];
+            int tentativeScore = visited[current.index].distance + cost;
+
+            if (tentativeScore < visited[neighbourIndex].distance)
+            {
+                Node gNeighbour = {neighbourIndex, current.index, tentativeScore};
+                visited[neighbourIndex] = gNeighbour;
+
+                int estimatedCostToGoal = heuristic(grid, neighbourIndex);
+
+                Node fNeighbour = {neighbourIndex, current.index, tentativeScore + estimatedCostToGoal};
+
+                if (minHeap.Find(neighbourIndex))
+                {
+                    minHeap.DecreasePriority(fNeighbour, fNeighbour.distance);
+                }
+                else
+                {
+                    minHeap.Insert(fNeighbour);
+                    Mark(neighbourIndex, cellFrontier);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Searches from both the start and the end. The end side keeps its labels in reverseVisited with parents pointing
+// back toward the end, and the two halves are joined at meetIndex once the search stops
+struct BidirectionalStepper : SearchStepper
+{
+    std::vector<Node> reverseVisited;
+    int meetIndex;
+    int bestDistance;
+
+    BidirectionalStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+    ~BidirectionalStepper();
+
+    Node *Labels(int side)
+    {
+        return side == 0 ? visited.data() : reverseVisited.data();
+    }
+
+    void MarkSide(int index, int side, CellState state)
+    {
+        Mark(index, side == 0 ? state : (state == cellVisited ? cellVisitedReverse : cellFrontierReverse));
+    }
+
+    // Records a cell labeled from both sides if it improves on the best meeting so far
+    void Meet(int index, int distance, int otherDistance);
+
+    // Points the forward parents along the reverse half of the path so it is traced like any other search
+    void JoinPaths();
+};
+
+BidirectionalStepper::BidirectionalStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch), meetIndex(-1), bestDistance(INT_MAX)
+{
+    if (scratch != NULL)
+    {
+        reverseVisited.swap(scratch->reverseVisited);
+    }
+    reverseVisited.resize(grid.Size());
+
+    for (int i = 0; i < grid.Size(); i++)
+    {
+        visited[i] = {i, -1, INT_MAX};
+        reverseVisited[i] = {i, -1, INT_MAX};
+    }
+
+    visited[startIndex].distance = 0;
+    reverseVisited[endIndex].distance = 0;
+    Mark(startIndex, cellFrontier);
+    Mark(endIndex, cellFrontierReverse);
+
+    if (startIndex == endIndex)
+    {
+        Meet(startIndex, 0, 0);
+    }
+}
+
+BidirectionalStepper::~BidirectionalStepper()
+{
+    if (scratch != NULL)
+    {
+        scratch->reverseVisited.swap(reverseVisited);
+    }
+}
+
+void BidirectionalStepper::Meet(int index, int distance, int otherDistance)
+{
+    if (otherDistance != INT_MAX && distance + otherDistance < bestDistance)
+    {
+        bestDistance = distance + otherDistance;
+        meetIndex = index;
+    }
+}
+
+void BidirectionalStepper::JoinPaths()
+{
+    result.found = true;
+
+    int previous = meetIndex;
+    int index = reverseVisited[meetIndex].parentIndex;
+
+    while (index != -1)
+    {
+        visited[index].parentIndex = previous;
+        previous = index;
+        index = reverseVisited[index].parentIndex;
+    }
+}
+
+// Expands whole BFS levels, always from the side with the smaller frontier. A meeting found while expanding a
+// level is only known to be shortest once the level is done, so every meeting of that level is compared
+struct BidirectionalBreadthFirstStepper : BidirectionalStepper
+{
+    std::vector<int> levels[2];
+    std::vector<int> nextLevels[2];
+    int side;
+    int position;
+
+    BidirectionalBreadthFirstStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+
+    bool Expand() override;
+};
+
+BidirectionalBreadthFirstStepper::BidirectionalBreadthFirstStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : BidirectionalStepper(grid, startIndex, endIndex, events, scratch), side(0), position(0)
+{
+    // Like the other searches, an end inside a wall is never reached
+    levels[0].push_back(startIndex);
+    if (!grid.IsWall(endIndex))
+    {
+        levels[1].push_back(endIndex);
+    }
+}
+
+bool BidirectionalBreadthFirstStepper::Expand()
+{
+    if (position == (int)levels[side].size())
+    {
+        if (meetIndex != -1)
+        {
+            JoinPaths();
+            return false;
+        }
+
+        levels[side].swap(nextLevels[side]);
+        nextLevels[side].clear();
+        position = 0;
+
+        // One side ran out of cells without meeting the other
+        if (levels[side].empty())
+        {
+            return false;
+        }
+
+        side = levels[0].size() <= levels[1].size() ? 0 : 1;
+        return true;
+    }
+
+    int index = levels[side][position++];
+    Node *labels = Labels(side);
+    Node *otherLabels = Labels(1 - side);
+    result.expansions++;
+    MarkSide(index, side, cellVisited);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex) && labels[neighbourIndex].distance == INT_MAX)
+        {
+            labels[neighbourIndex] = {neighbourIndex, index, labels[index].distance + 1};
+            nextLevels[side].push_back(neighbourIndex);
+            MarkSide(neighbourIndex, side, cellFrontier);
+            Meet(neighbourIndex, labels[neighbourIndex].distance, otherLabels[neighbourIndex].distance);
+        }
+    }
+    return true;
+}
+
+// Bidirectional Dijkstra, or A* with the average of the Manhattan distances to both ends as potential so the two
+// searches agree on reduced edge costs. Keys are doubled to keep the halved potential integral. The search stops
+// once the smallest keys of both sides together cannot beat the best meeting, which stays correct on weighted cells
+template <typename PriorityQueue>
+struct BidirectionalDijkstraStepper : BidirectionalStepper
+{
+    PriorityQueue queues[2];
+    bool heuristic;
+    Coordinates startCoord;
+    Coordinates endCoord;
+
+    BidirectionalDijkstraStepper(const Grid &grid, int startIndex, int endIndex, bool heuristic, PriorityQueue &&forwardQueue, PriorityQueue &&reverseQueue, EventRing *events, SearchScratch *scratch);
+    ~BidirectionalDijkstraStepper();
+
+    bool Expand() override;
+
+    // Doubled forward potential of a cell, the reverse search uses its negation
+    int Potential(int index) const
+    {
+        if (!heuristic)
+        {
+            return 0;
+        }
+
+        Coordinates coord = IndexToGridIndexes(grid, index);
+        return ManhattanDistance(coord, endCoord) - ManhattanDistance(coord, startCoord);
+    }
+
+    int Key(int index, int distance, int side) const
+    {
+        return 2 * distance + (side == 0 ? Potential(index) : -Potential(index));
+    }
+};
+
+template <typename PriorityQueue>
+BidirectionalDijkstraStepper<PriorityQueue>::BidirectionalDijkstraStepper(const Grid &grid, int startIndex, int endIndex, bool heuristic, PriorityQueue &&forwardQueue, PriorityQueue &&reverseQueue, EventRing *events, SearchScratch *scratch)
+    : BidirectionalStepper(grid, startIndex, endIndex, events, scratch), queues{std::move(forwardQueue), std::move(reverseQueue)}, heuristic(heuristic)
+{
+    startCoord = IndexToGridIndexes(grid, startIndex);
+    endCoord = IndexToGridIndexes(grid, endIndex);
+
+    queues[0].Insert({startIndex, -1, Key(startIndex, 0, 0)});
+    if (!grid.IsWall(endIndex))
+    {
+        queues[1].Insert({endIndex, -1, Key(endIndex, 0, 1)});
+    }
+}
+
+template <typename PriorityQueue>
+BidirectionalDijkstraStepper<PriorityQueue>::~BidirectionalDijkstraStepper()
+{
+    queues[0].Release(LentQueue(scratch, 0));
+    queues[1].Release(LentQueue(scratch, 1));
+}
+
+template <typename PriorityQueue>
+bool BidirectionalDijkstraStepper<PriorityQueue>::Expand()
+{
+    // Either side running dry means every path has been considered
+    if (queues[0].IsEmpty() || queues[1].IsEmpty())
+    {
+        if (meetIndex != -1)
+        {
+            JoinPaths();
+        }
+        return false;
+    }
+
+    if (meetIndex != -1 && queues[0].MinPriority() + queues[1].MinPriority() >= 2 * bestDistance)
+    {
+        JoinPaths();
+        return false;
+    }
+
+    int side = queues[0].size <= queues[1].size ? 0 : 1;
+    Node *labels = Labels(side);
+    Node *otherLabels = Labels(1 - side);
+
+    Node current = queues[side].ExtractMin();
+    int currentDistance = labels[current.index].distance;
+    result.expansions++;
+    MarkSide(current.index, side, cellVisited);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = current.index + grid.offsets[i];
+        if (!grid.IsWall(neighbourIndex))
+        {
+            // Edges are weighted by the cell entered, which is the current cell when searching backwards
+            int cost = side == 0 ? grid.costs[neighbourIndex] : grid.costs[current.index];
+            int newDistance = currentDistance + cost;
+
+            if (newDistance < labels[neighbourIndex].distance)
+            {
+                labels[neighbourIndex] = {neighbourIndex, current.index, newDistance};
+                Node neighbour = {neighbourIndex, current.index, Key(neighbourIndex, newDistance, side)};
+
+                if (queues[side].Find(neighbourIndex))
+                {
+                    queues[side].DecreasePriority(neighbour, neighbour.distance);
+                }
+                else
+                {
+                    queues[side].Insert(neighbour);
+                    MarkSide(neighbourIndex, side, cellFrontier);
+                }
+
+                Meet(neighbourIndex, newDistance, otherLabels[neighbourIndex].distance);
+            }
+        }
+    }
+    return true;
+}
+
+// Jump Point Search restricted to 4-connected moves, after PathFinding.js' never-diagonal variant. Only jump points
+// enter the open list, the cells between them are filled in once the end is extracted
+struct JumpPointStepper : SearchStepper
+{
+    MinHeap openList = {0};
+    Coordinates endCoord;
+
+    JumpPointStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+    ~JumpPointStepper();
+
+    bool Expand() override;
+
+    // Next jump point from index moving in a direction, -1 when a wall comes first
+    virtual int Jump(int index, int direction);
+
+    bool IsForced(int index, int direction) const;
+    int TravelDirection(int fromIndex, int toIndex) const;
+    void FillPath();
+};
+
+JumpPointStepper::JumpPointStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : SearchStepper(grid, startIndex, endIndex, events, scratch)
+{
+    openList.Reserve(grid.Size(), LentQueue(scratch, 0));
+
+    for (int i = 0; i < grid.Size(); i++)
+    {
+        visited[i].distance = INT_MAX;
+        visited[i].parentIndex = -1;
+    }
+
+    Coordinates startCoord = IndexToGridIndexes(grid, startIndex);
+    endCoord = IndexToGridIndexes(grid, endIndex);
+    Node start = {startIndex, -1, ManhattanDistance(startCoord, endCoord)};
+
+    openList.Insert(start);
+    visited[startIndex] = {startIndex, -1, 0};
+    Mark(startIndex, cellFrontier);
+}
+
+JumpPointStepper::~JumpPointStepper()
+{
+    openList.Release(LentQueue(scratch, 0));
+}
+
+// A cell is a jump point when a wall beside the previous cell opens up beside this one
+static bool IsForcedCell(const Grid &grid, int index, int direction)
+{
+    int back = -grid.offsets[direction];
+    int side = direction == directionLeft || direction == directionRight ? grid.stride : 1;
+
+    return (!grid.IsWall(index - side) && grid.IsWall(index - side + back)) ||
+           (!grid.IsWall(index + side) && grid.IsWall(index + side + back));
+}
+
+bool JumpPointStepper::IsForced(int index, int direction) const
+{
+    return IsForcedCell(grid, index, direction);
+}
+
+int JumpPointStepper::TravelDirection(int fromIndex, int toIndex) const
+{
+    int difference = toIndex - fromIndex;
+
+    if (Absolute(difference) < grid.stride)
+    {
+        return difference > 0 ? directionRight : directionLeft;
+    }
+    return difference > 0 ? directionDown : directionUp;
+}
+
+int JumpPointStepper::Jump(int index, int direction)
+{
+    int step = grid.offsets[direction];
+    bool horizontal = direction == directionLeft || direction == directionRight;
+
+    while (true)
+    {
+        index += step;
+
+        if (grid.IsWall(index))
+        {
+            return -1;
+        }
+        if (index == endIndex || IsForced(index, direction))
+        {
+            return index;
+        }
+
+        // Moving vertically, stop wherever a horizontal jump would find something
+        if (!horizontal && (Jump(index, directionLeft) != -1 || Jump(index, directionRight) != -1))
+        {
+            return index;
+        }
+    }
+}
+
+// Replaces the jump point parents along the path with per cell parents so it can be traced like any other search
+void JumpPointStepper::FillPath()
+{
+    int index = endIndex;
+
+    while (visited[index].parentIndex != -1)
+    {
+        int parentIndex = visited[index].parentIndex;
+        int step = grid.offsets[TravelDirection(index, parentIndex)];
+
+        for (int cell = index; cell != parentIndex; cell += step)
+        {
+            visited[cell].parentIndex = cell + step;
+        }
+        index = parentIndex;
+    }
+}
+
+bool JumpPointStepper::Expand()
+{
+    if (openList.IsEmpty())
+    {
+        return false;
+    }
+
+    Node current = openList.ExtractMin();
+    result.expansions++;
+    Mark(current.index, cellVisited);
+
+    if (current.index == endIndex)
+    {
+        result.found = true;
+        FillPath();
+        return false;
+    }
+
+    // Never jump back the way we came
+    int parentIndex = visited[current.index].parentIndex;
+    int back = parentIndex == -1 ? -1 : (TravelDirection(parentIndex, current.index) + 2) % 4;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (i == back)
+        {
+            continue;
+        }
+
+        int jumpIndex = Jump(current.index, i);
+        if (jumpIndex == -1)
+        {
+            continue;
+        }
+
+        Coordinates currentCoord = IndexToGridIndexes(grid, current.index);
+        Coordinates jumpCoord = IndexToGridIndexes(grid, jumpIndex);
+        int tentativeScore = visited[current.index].distance + ManhattanDistance(currentCoord, jumpCoord);
+
+        if (tentativeScore < visited[jumpIndex].distance)
+        {
+            visited[jumpIndex] = {jumpIndex, current.index, tentativeScore};
+
+            Node fNeighbour = {jumpIndex, current.index, tentativeScore + ManhattanDistance(jumpCoord, endCoord)};
+
+            if (openList.Find(jumpIndex))
+            {
+                openList.DecreasePriority(fNeighbour, fNeighbour.distance);
+            }
+            else
+            {
+                openList.Insert(fNeighbour);
+                Mark(jumpIndex, cellFrontier);
+            }
+        }
+    }
+    return true;
+}
+
+// Longest jump stored in the tables, longer runs are split by treating the cell at the limit as a jump point
+#define JUMP_DISTANCE_LIMIT 32767
+
+void JumpTable::Build(const Grid &grid)
+{
+    rows = grid.rows;
+    cols = grid.cols;
+    generation = grid.generation;
+
+    // Vertical jump points depend on the horizontal tables
+    BuildDistances(grid, directionLeft, false);
+    BuildDistances(grid, directionRight, false);
+    BuildDistances(grid, directionUp, true);
+    BuildDistances(grid, directionDown, true);
+}
+
+bool JumpTable::Matches(const Grid &grid) const
+{
+    return rows == grid.rows && cols == grid.cols && generation == grid.generation;
+}
+
+void JumpTable::BuildDistances(const Grid &grid, int direction, bool vertical)
+{
+    std::vector<int16_t> &distances = jumpDistances[direction];
+    int step = grid.offsets[direction];
+
+    distances.assign(grid.Size(), 0);
+
+    // Walk against the direction so the next cell is always done first
+    for (int r = 0; r < grid.rows; r++)
+    {
+        int y = vertical && step > 0 ? grid.rows - 1 - r : r;
+
+        for (int c = 0; c < grid.cols; c++)
+        {
+            int x = !vertical && step > 0 ? grid.cols - 1 - c : c;
+            int index = grid.Index(x, y);
+            int next = index + step;
+
+            if (grid.IsWall(index) || grid.IsWall(next))
+            {
+                continue;
+            }
+
+            bool jumpPoint = IsForcedCell(grid, next, direction);
+            if (vertical)
+            {
+                jumpPoint = jumpPoint || jumpDistances[directionLeft][next] > 0 || jumpDistances[directionRight][next] > 0;
+            }
+
+            int distance = distances[next];
+            if (jumpPoint)
+            {
+                distances[index] = 1;
+            }
+            else if (distance > 0)
+            {
+                distances[index] = distance < JUMP_DISTANCE_LIMIT ? distance + 1 : 1;
+            }
+            else
+            {
+                distances[index] = distance > -JUMP_DISTANCE_LIMIT ? distance - 1 : 1;
+            }
+        }
+    }
+}
+
+// JPS with the jumps turned into JumpTable lookups plus a check for the end
+struct JumpPointPlusStepper : JumpPointStepper
+{
+    const JumpTable *table;
+
+    // Built here when the caller has neither a table nor a scratch to keep one in
+    JumpTable ownTable;
+
+    JumpPointPlusStepper(const JumpTable *table, const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch);
+
+    int Jump(int index, int direction) override;
+};
+
+JumpPointPlusStepper::JumpPointPlusStepper(const JumpTable *table, const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+    : JumpPointStepper(grid, startIndex, endIndex, events, scratch), table(table)
+{
+    if (table == NULL)
+    {
+        JumpTable &built = scratch != NULL ? scratch->jumpTable : ownTable;
+        if (!built.Matches(grid))
+        {
+            built.Build(grid);
+        }
+        this->table = &built;
+    }
+}
+
+int JumpPointPlusStepper::Jump(int index, int direction)
+{
+    const std::vector<int16_t> *jumpDistances = table->jumpDistances;
+    int step = grid.offsets[direction];
+    int distance = jumpDistances[direction][index];
+    int reach = Absolute(distance);
+    bool horizontal = direction == directionLeft || direction == directionRight;
+
+    // Steps along the direction to the end's column or row
+    Coordinates coord = IndexToGridIndexes(grid, index);
+    int sign = step > 0 ? 1 : -1;
+    int alongEnd = horizontal ? (endCoord.x - coord.x) * sign : (endCoord.y - coord.y) * sign;
+    bool aligned = horizontal ? endCoord.y == coord.y : endCoord.x == coord.x;
+
+    if (alongEnd > 0 && alongEnd <= reach)
+    {
+        if (aligned)
+        {
+            return endIndex;
+        }
+
+        // Crossing the end's row, stop where the end can be reached horizontally
+        if (!horizontal)
+        {
+            int crossing = index + alongEnd * step;
+            int toEnd = endCoord.x > coord.x ? directionRight : directionLeft;
+
+            if (Absolute(endCoord.x - coord.x) <= -jumpDistances[toEnd][crossing])
+            {
+                return crossing;
+            }
+        }
+    }
+    return distance > 0 ? index + distance * step : -1;
+}
+
+std::unique_ptr<SearchStepper> CreateSearchStepper(SearchType type, const Grid &grid, int startIndex, int endIndex, QueueBackend backend, EventRing *events, SearchScratch *scratch)
+{
+    switch (type)
+    {
+    case searchDepthFirst:
+        return std::make_unique<DepthFirstSearchStepper>(grid, startIndex, endIndex, events, scratch);
+    case searchBreadthFirst:
+        return std::make_unique<BreadthFirstSearchStepper>(grid, startIndex, endIndex, events, scratch);
+    case searchJumpPoint:
+    case searchJumpPointPlus:
+        // Jump points only preserve optimality on uniform costs
+        if (grid.MaxCost() > DEFAULT_COST)
+        {
+            return CreateSearchStepper(searchAStar, grid, startIndex, endIndex, backend, events, scratch);
+        }
+        if (type == searchJumpPointPlus)
+        {
+            return std::make_unique<JumpPointPlusStepper>((const JumpTable *)NULL, grid, startIndex, endIndex, events, scratch);
+        }
+        return std::make_unique<JumpPointStepper>(grid, startIndex, endIndex, events, scratch);
+    case searchDijkstra:
+    case searchAStar:
+    {
+        int maxCost = grid.MaxCost();
+        bool heuristic = type == searchAStar;
+
+        if (UseBucketQueue(backend, maxCost))
+        {
+            BucketQueue bucketQueue = {0};
+            bucketQueue.Reserve(grid.Size(), BucketCount(maxCost, heuristic), LentQueue(scratch, 0));
+
+            if (heuristic)
+            {
+                return std::make_unique<AStarStepper<BucketQueue, ManhattanHeuristic>>(grid, startIndex, endIndex, std::move(bucketQueue), ManhattanHeuristic(grid, endIndex), events, scratch);
+            }
+            return std::make_unique<DijkstraStepper<BucketQueue>>(grid, startIndex, endIndex, std::move(bucketQueue), events, scratch);
+        }
+
+        MinHeap minHeap = {0};
+        minHeap.Reserve(grid.Size(), LentQueue(scratch, 0));
+
+        if (heuristic)
+        {
+            return std::make_unique<AStarStepper<MinHeap, ManhattanHeuristic>>(grid, startIndex, endIndex, std::move(minHeap), ManhattanHeuristic(grid, endIndex), events, scratch);
+        }
+        return std::make_unique<DijkstraStepper<MinHeap>>(grid, startIndex, endIndex, std::move(minHeap), events, scratch);
+    }
+    case searchBidirectionalBreadthFirst:
+        return std::make_unique<BidirectionalBreadthFirstStepper>(grid, startIndex, endIndex, events, scratch);
+    case searchBidirectionalDijkstra:
+    case searchBidirectionalAStar:
+    {
+        int maxCost = grid.MaxCost();
+        bool heuristic = type == searchBidirectionalAStar;
+
+        if (UseBucketQueue(backend, maxCost))
+        {
+            BucketQueue bucketQueues[2] = {{0}, {0}};
+            bucketQueues[0].Reserve(grid.Size(), BidirectionalBucketCount(maxCost, heuristic), LentQueue(scratch, 0));
+            bucketQueues[1].Reserve(grid.Size(), BidirectionalBucketCount(maxCost, heuristic), LentQueue(scratch, 1));
+
+            return std::make_unique<BidirectionalDijkstraStepper<BucketQueue>>(grid, startIndex, endIndex, heuristic, std::move(bucketQueues[0]), std::move(bucketQueues[1]), events, scratch);
+        }
+
+        MinHeap minHeaps[2] = {{0}, {0}};
+        minHeaps[0].Reserve(grid.Size(), LentQueue(scratch, 0));
+        minHeaps[1].Reserve(grid.Size(), LentQueue(scratch, 1));
+
+        return std::make_unique<BidirectionalDijkstraStepper<MinHeap>>(grid, startIndex, endIndex, heuristic, std::move(minHeaps[0]), std::move(minHeaps[1]), events, scratch);
+    }
+    }
+    return NULL;
+}
+
+std::unique_ptr<SearchStepper> CreateLandmarkStepper(const LandmarkTable &table, const Grid &grid, int startIndex, int endIndex, QueueBackend backend, EventRing *events, SearchScratch *scratch)
+{
+    int maxCost = grid.MaxCost();
+    LandmarkHeuristic heuristic(table, grid, endIndex);
+
+    if (UseBucketQueue(backend, maxCost))
+    {
+        BucketQueue bucketQueue = {0};
+        bucketQueue.Reserve(grid.Size(), LandmarkBucketCount(maxCost), LentQueue(scratch, 0));
+
+        return std::make_unique<AStarStepper<BucketQueue, LandmarkHeuristic>>(grid, startIndex, endIndex, std::move(bucketQueue), heuristic, events, scratch);
+    }
+
+    MinHeap minHeap = {0};
+    minHeap.Reserve(grid.Size(), LentQueue(scratch, 0));
+
+    return std::make_unique<AStarStepper<MinHeap, LandmarkHeuristic>>(grid, startIndex, endIndex, std::move(minHeap), heuristic, events, scratch);
+}
+
+std::unique_ptr<SearchStepper> CreateJumpPointPlusStepper(const JumpTable &table, const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch)
+{
+    if (grid.MaxCost() > DEFAULT_COST)
+    {
+        return CreateSearchStepper(searchAStar, grid, startIndex, endIndex, queueAuto, events, scratch);
+    }
+    return std::make_unique<JumpPointPlusStepper>(&table, grid, startIndex, endIndex, events, scratch);
+}
+
+SearchResult RunJumpPointPlusSearch(const JumpTable &table, const Grid &grid, int startIndex, int endIndex)
+{
+    std::unique_ptr<SearchStepper> stepper = CreateJumpPointPlusStepper(table, grid, startIndex, endIndex);
+
+    stepper->Step(LLONG_MAX);
+    return stepper->result;
+}
+
+SearchResult RunLandmarkSearch(const LandmarkTable &table, const Grid &grid, int startIndex, int endIndex, QueueBackend backend)
+{
+    std::unique_ptr<SearchStepper> stepper = CreateLandmarkStepper(table, grid, startIndex, endIndex, backend);
+
+    stepper->Step(LLONG_MAX);
+    return stepper->result;
+}
+
+SearchResult RunSearch(SearchType type, const Grid &grid, int startIndex, int endIndex, QueueBackend backend)
+{
+    std::unique_ptr<SearchStepper> stepper = CreateSearchStepper(type, grid, startIndex, endIndex, backend);
+
+    stepper->Step(LLONG_MAX);
+    return stepper->result;
+}
+
+// Maze generators carve into a grid filled with walls, reporting every carved cell
+struct MazeStepper : Stepper
+{
+    Grid &grid;
+
+    MazeStepper(Grid &grid, EventRing *events) : Stepper(events), grid(grid) {}
+
+    void Carve(int index)
+    {
+        grid.SetWall(index, false);
+        Emit(index, eventCarve);
+    }
+};
+
+struct PrimsMazeStepper : MazeStepper
+{
+    RandomSet wallList;
+
+    PrimsMazeStepper(Grid &grid, EventRing *events);
+
+    bool Step(long long steps) override;
+};
+
+PrimsMazeStepper::PrimsMazeStepper(Grid &grid, EventRing *events)
+    : MazeStepper(grid, events)
+{
+    // Start with grid filled with walls and keep track of walls being processed. A wall only
+    // gains path neighbours once processed, so it never needs to be added to the frontier twice
+    wallList.Reserve(grid.Size());
+
+    // Random number for start cell
+    int randStartCell = grid.Index(RandomValue(0, grid.cols - 1), RandomValue(0, grid.rows - 1));
+
+    // Mark random start cell as maze path
+    Carve(randStartCell);
+    wallList.added[randStartCell] = true;
+
+    int indexes[4] = {-1, -1, -1, -1};
+
+    GetNeighbourIndexes(grid, randStartCell, indexes);
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (indexes[i] != -1)
+        {
+            wallList.Insert(indexes[i]);
+        }
+    }
+}
+
+bool PrimsMazeStepper::Step(long long steps)
+{
+    while (steps > 0 && !cancelled && !wallList.IsEmpty())
+    {
+        steps--;
+
+        // Remove a random wall from the frontier
+        int randomWall = RandomValue(0, wallList.Size() - 1);
+        int index = wallList.RemoveAtIndex(randomWall);
+        int neighbourPathCount = 0;
+
+        int indexes[4] = {-1, -1, -1, -1};
+        GetNeighbourIndexes(grid, index, indexes);
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (indexes[i] != -1 && !grid.IsWall(indexes[i]))
+            {
+                neighbourPathCount++;
+                indexes[i] = -1;
+            }
+        }
+
+        if (neighbourPathCount <= 1)
+        {
+            Carve(index);
+            for (int i = 0; i < 4; i++)
+            {
+                if (indexes[i] != -1)
+                {
+                    wallList.Insert(indexes[i]);
+                }
+            }
+        }
+    }
+
+    finished = wallList.IsEmpty();
+    return finished;
+}
+
+struct DFSMazeStepper : MazeStepper
+{
+    Stack wallList;
+
+    DFSMazeStepper(Grid &grid, EventRing *events);
+
+    bool Step(long long steps) override;
+};
+
+DFSMazeStepper::DFSMazeStepper(Grid &grid, EventRing *events)
+    : MazeStepper(grid, events)
+{
+    // Random number for start cell
+    int randStartCell = grid.Index(RandomValue(0, grid.cols - 1), RandomValue(0, grid.rows - 1));
+
+    // Mark random start cell as maze path
+    Carve(randStartCell);
+
+    Node randStartNode = {randStartCell};
+
+    wallList.Push(randStartNode);
+}
+
+bool DFSMazeStepper::Step(long long steps)
+{
+    while (steps > 0 && !cancelled && !wallList.IsEmpty())
+    {
+        steps--;
+
+        Node node = wallList.Pop();
+
+        int indexes[4] = {-1, -1, -1, -1};
+        GetNeighbourIndexes(grid, node.index, indexes);
+
+        int availableNeighbours = 4;
+        for (int i = 0; i < 4; i++)
+        {
+            if (indexes[i] == -1 || !grid.IsWall(indexes[i]))
+            {
+                availableNeighbours--;
+                indexes[i] = -1;
+            }
+            // Check if neighbour would create a loop
+            else
+            {
+                int neighbourIndexes[4] = {-1, -1, -1, -1};
+                GetNeighbourIndexes(grid, indexes[i], neighbourIndexes);
+
+                int neighbourPathCount = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    if (neighbourIndexes[i] != -1 && !grid.IsWall(neighbourIndexes[i]))
+                    {
+                        neighbourPathCount++;
+                        neighbourIndexes[i] = -1;
+                    }
+                }
+
+                if (neighbourPathCount > 1)
+                {
+                    availableNeighbours--;
+                    indexes[i] = -1;
+                }
+            }
+        }
+
+        if (availableNeighbours > 0)
+        {
+            wallList.Push(node);
+            int randIndex = RandomValue(0, availableNeighbours - 1);
+            int currIndex = 0;
+            int foundIndex = 0;
+
+            for (int i = 0; i < 4; i++)
+            {
+                if (indexes[i] != -1 && grid.IsWall(indexes[i]))
+                {
+                    if (currIndex == randIndex)
+                    {
+                        foundIndex = i;
+                    }
+                    currIndex++;
+                }
+            }
+            Carve(indexes[foundIndex]);
+            Node wall = {indexes[foundIndex]};
+            wallList.Push(wall);
+        }
+    }
+
+    finished = wallList.IsEmpty();
+    return finished;
+}
+
+// Carves the first row, then every other row one cell per step
+struct SidewinderMazeStepper : MazeStepper
+{
+    std::vector<int> availableNodes;
+    int row;
+    int col;
+    int runStartIndex;
+    bool skipNext;
+
+    SidewinderMazeStepper(Grid &grid, EventRing *events);
+
+    bool Step(long long steps) override;
+    void CarveCell();
+};
+
+SidewinderMazeStepper::SidewinderMazeStepper(Grid &grid, EventRing *events)
+    : MazeStepper(grid, events), availableNodes(grid.cols), row(0), col(0), runStartIndex(0), skipNext(false)
+{
+}
+
+void SidewinderMazeStepper::CarveCell()
+{
+    int cols = grid.cols;
+    int i = row;
+    int j = col;
+
+    if (skipNext)
+    {
+        skipNext = false;
+        return;
+    }
+
+    // Current cell is a path
+    int index = grid.Index(j, i);
+    Carve(index);
+
+    int goEast = RandomValue(0, 1);
+
+    // Edge of the maze
+    if (j == cols - 1)
+    {
+        goEast = false;
+    }
+
+    if (j + 1 >= cols || !goEast)
+    {
+        int numAvailable = 0;
+
+        for (int x = runStartIndex; x < j + 1; x++)
+        {
+            int northIndex = grid.Index(x, i) + 2 * grid.offsets[directionUp];
+            if (!grid.IsWall(northIndex))
+            {
+                availableNodes[numAvailable++] = x;
+            }
+        }
+
+        if (numAvailable == 0)
+        {
+            // Make sure edge of the maze is connected
+            if (j == cols - 1)
+            {
+                Carve(index + grid.offsets[directionLeft]);
+            }
+            return;
+        }
+
+        int randIndex = RandomValue(0, numAvailable - 1);
+
+        // Path north of a cell that has been visited in this row
+        index = grid.Index(availableNodes[randIndex], i) + grid.offsets[directionUp];
+        Carve(index);
+
+        runStartIndex = j + 2;
+        skipNext = true;
+    }
+}
+
+bool SidewinderMazeStepper::Step(long long steps)
+{
+    while (steps > 0 && !cancelled && !finished)
+    {
+        steps--;
+
+        // First row path
+        if (row == 0)
+        {
+            Carve(grid.Index(col, 0));
+        }
+        else
+        {
+            CarveCell();
+        }
+
+        // Next row
+        if (++col == grid.cols)
+        {
+            row += 2;
+            col = 0;
+            runStartIndex = 0;
+            skipNext = false;
+        }
+
+        finished = row >= grid.rows;
+    }
+    return finished;
+}
+
+std::unique_ptr<Stepper> CreateMazeStepper(MazeType type, Grid &grid, EventRing *events)
+{
+    switch (type)
+    {
+    case mazePrim:
+        return std::make_unique<PrimsMazeStepper>(grid, events);
+    case mazeDfs:
+        return std::make_unique<DFSMazeStepper>(grid, events);
+    case mazeSidewinder:
+        return std::make_unique<SidewinderMazeStepper>(grid, events);
+    }
+    return NULL;
+}
+
+void GenerateMaze(MazeType type, Grid &grid)
+{
+    std::unique_ptr<Stepper> stepper = CreateMazeStepper(type, grid);
+
+    stepper->Step(LLONG_MAX);
+}
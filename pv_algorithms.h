@@ -1,21 +1,186 @@
-#ifndef PV_ALGORITHMS_H
-#define PV_ALGORITHMS_H
-
-#include "raylib.h"
-#include "pv_gui.h"
-
-#include <atomic>
-
-void RandomizedPrimsMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done);
-void RandomizedDFSMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done);
-void SidewinderMaze(Cell cells[], int rows, int cols, std::atomic<bool> &done);
-
-void DepthFirstSearch(Cell cells[], int rows, int cols, int start, int end, std::atomic<bool> &done);
-void BreadthFirstSearch(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done);
-void Dijkstra(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done);
-void AStar(Cell cells[], int rows, int cols, int startIndex, int endIndex, std::atomic<bool> &done);
-
-bool operator==(Color c1, Color c2);
-bool operator!=(Color c1, Color c2);
-
-#endif
\ No newline at end of file
+#ifndef PV_ALGORITHMS_H
+#define PV_ALGORITHMS_H
+
+#include "pv_grid.h"
+#include "pv_events.h"
+
+#include <memory>
+#include <vector>
+
+// Largest edge cost for which the bucket queue is picked automatically
+#define BUCKET_QUEUE_MAX_COST 64
+
+// Outcome of a search, path length counts moves and path cost sums the cost of every cell entered
+struct SearchResult
+{
+    bool found;
+    int pathLength;
+    int pathCost;
+    long long expansions;
+};
+
+// Priority queue used by Dijkstra and A*
+enum QueueBackend
+{
+    queueAuto,
+    queueBinaryHeap,
+    queueBucket
+};
+
+enum SearchType
+{
+    searchDepthFirst,
+    searchBreadthFirst,
+    searchDijkstra,
+    searchAStar,
+    searchJumpPoint,
+    searchJumpPointPlus,
+    searchBidirectionalBreadthFirst,
+    searchBidirectionalDijkstra,
+    searchBidirectionalAStar
+};
+
+enum MazeType
+{
+    mazePrim,
+    mazeDfs,
+    mazeSidewinder
+};
+
+struct LandmarkTable;
+
+struct Node
+{
+    int index;
+    int parentIndex;
+    int distance;
+};
+
+// Resumable algorithm. A step expands one node, traces one path cell or carves one maze cell,
+// so the caller decides how much work happens before it gets control back
+struct Stepper
+{
+    bool finished;
+
+    // Set once a push found the ring cancelled, Step then returns after the step it is on
+    bool cancelled;
+
+    // Cell changes are pushed here for the renderer, headless runs pass NULL
+    EventRing *events;
+
+    Stepper(EventRing *events) : finished(false), cancelled(false), events(events) {}
+    virtual ~Stepper() {}
+
+    // Runs at most steps steps, returns true once the algorithm has finished
+    virtual bool Step(long long steps) = 0;
+
+    void Emit(int index, GridEventType type)
+    {
+        if (events != NULL && !cancelled && !events->Push(MakeGridEvent(index, type)))
+        {
+            cancelled = true;
+        }
+    }
+};
+
+// JPS+ table of, for every cell and direction, the steps to the next jump point (positive) or the number of open cells
+// before a wall (zero or negative). Built once per grid generation and shared by every JPS+ search on that grid, so a
+// query only pays for its lookups. Like the path cache, a table only knows the generation of the grid it was built for
+struct JumpTable
+{
+    int rows;
+    int cols;
+    uint64_t generation;
+    std::vector<int16_t> jumpDistances[4];
+
+    JumpTable() : rows(0), cols(0), generation(0) {}
+
+    void Build(const Grid &grid);
+
+    // True when the table was built for this grid as it is now, any edit to a wall or weight makes it stale
+    bool Matches(const Grid &grid) const;
+
+    void BuildDistances(const Grid &grid, int direction, bool vertical);
+};
+
+// Storage of one queue lent by a scratch. The binary heap, stack and FIFO queue keep elements and positions, the bucket
+// queue the rest
+struct QueueScratch
+{
+    std::vector<Node> elements;
+    std::vector<int> positions;
+    std::vector<int> heads;
+    std::vector<int> next;
+    std::vector<int> prev;
+    std::vector<Node> nodes;
+    std::vector<bool> queued;
+};
+
+// Buffers lent to a search, reused by the next search given the same scratch: the per cell labels and states, the
+// reverse labels of the bidirectional searches, the queues and the JPS+ table. Lets a worker that runs many searches
+// one after another keep its memory instead of allocating it again for every search
+struct SearchScratch
+{
+    std::vector<Node> visited;
+    std::vector<uint8_t> states;
+    std::vector<Node> reverseVisited;
+
+    // Bidirectional searches take one queue per side, the others only the first
+    QueueScratch queues[2];
+
+    // Built again by a JPS+ search once the grid generation moved on
+    JumpTable jumpTable;
+};
+
+// Search from the start to the end cell. Only reads the grid, search progress is kept in its own
+// states and reported through events
+struct SearchStepper : Stepper
+{
+    const Grid &grid;
+    int startIndex;
+    int endIndex;
+    SearchResult result;
+    std::vector<Node> visited;
+    std::vector<uint8_t> states;
+
+    bool tracing;
+    int traceIndex;
+
+    // Lender of visited, states and the queue storage, which go back to it when the search is destroyed
+    SearchScratch *scratch;
+
+    SearchStepper(const Grid &grid, int startIndex, int endIndex, EventRing *events, SearchScratch *scratch = NULL);
+    ~SearchStepper();
+
+    bool Step(long long steps) override;
+
+    void Mark(int index, CellState state);
+
+    // Every cell from the start to the end once the search has finished, empty when the end was not found
+    void TracePath(std::vector<int> &path) const;
+
+    // Expands one node, returns false once the end has been found or the frontier is empty
+    virtual bool Expand() = 0;
+};
+
+// Seeds the random engine used by the maze generators
+void SetAlgorithmSeed(unsigned int seed);
+
+// Maze generators carve paths out of a grid filled with walls
+std::unique_ptr<Stepper> CreateMazeStepper(MazeType type, Grid &grid, EventRing *events = NULL);
+std::unique_ptr<SearchStepper> CreateSearchStepper(SearchType type, const Grid &grid, int startIndex, int endIndex, QueueBackend backend = queueAuto, EventRing *events = NULL, SearchScratch *scratch = NULL);
+
+// A* bounded by the landmark table, which must have been built for this grid
+std::unique_ptr<SearchStepper> CreateLandmarkStepper(const LandmarkTable &table, const Grid &grid, int startIndex, int endIndex, QueueBackend backend = queueAuto, EventRing *events = NULL, SearchScratch *scratch = NULL);
+
+// JPS+ over a table built for this grid, falls back to A* on weighted grids like searchJumpPointPlus does.
+// CreateSearchStepper uses the table of the scratch, or builds one for the search without a scratch
+std::unique_ptr<SearchStepper> CreateJumpPointPlusStepper(const JumpTable &table, const Grid &grid, int startIndex, int endIndex, EventRing *events = NULL, SearchScratch *scratch = NULL);
+
+// Run an algorithm to completion
+void GenerateMaze(MazeType type, Grid &grid);
+SearchResult RunSearch(SearchType type, const Grid &grid, int startIndex, int endIndex, QueueBackend backend = queueAuto);
+SearchResult RunJumpPointPlusSearch(const JumpTable &table, const Grid &grid, int startIndex, int endIndex);
+SearchResult RunLandmarkSearch(const LandmarkTable &table, const Grid &grid, int startIndex, int endIndex, QueueBackend backend = queueAuto);
+
+#endif
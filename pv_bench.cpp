@@ -0,0 +1,834 @@
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+#include "pv_parallel.h"
+#include "pv_bitboard.h"
+#include "pv_hierarchy.h"
+#include "pv_dstar.h"
+#include "pv_landmarks.h"
+#include "pv_flowfield.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Benchmark sweep of every solver over every map type and grid size
+
+// Heap usage is tracked by replacing the global allocator, so each run reports the peak bytes it allocated.
+// The counters are atomic because the parallel solvers allocate from their worker threads
+static std::atomic<size_t> currentBytes(0);
+static std::atomic<size_t> peakBytes(0);
+
+// Shared by the parallel solvers, created once the options are known
+static ThreadPool *threadPool = NULL;
+
+// Abstract graph built by hpa-build and queried by hpa, which runs right after it on the same map
+static HierarchicalGraph hierarchy;
+
+// Jump table built by jps+-build and queried by jps+, in the same way
+static JumpTable jumpTable;
+
+// Landmark table built by alt-build and queried by alt, in the same way
+static LandmarkTable landmarkTable;
+
+// Size header kept in front of every allocation, padded to keep the returned block aligned
+struct AllocationHeader
+{
+    size_t size;
+    size_t padding;
+};
+
+void *operator new(size_t size)
+{
+    AllocationHeader *header = (AllocationHeader *)malloc(sizeof(AllocationHeader) + size);
+
+    if (header == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    header->size = size;
+    size_t current = currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+
+    while (current > peak && !peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+    return header + 1;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer != NULL)
+    {
+        AllocationHeader *header = (AllocationHeader *)pointer - 1;
+        currentBytes.fetch_sub(header->size, std::memory_order_relaxed);
+        free(header);
+    }
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+enum MapTypes
+{
+    mapPrim,
+    mapDfs,
+    mapSidewinder,
+    mapOpen,
+    mapRandom
+};
+
+static const char *mapNames[] = {"prim", "dfs", "sidewinder", "open", "random"};
+static const int mapCount = 5;
+
+enum SolverTypes
+{
+    solverDepthFirstSearch,
+    solverBreadthFirstSearch,
+    solverDijkstraHeap,
+    solverDijkstraBucket,
+    solverAStarHeap,
+    solverAStarBucket,
+    solverJumpPoint,
+    solverJumpPointPlusBuild,
+    solverJumpPointPlus,
+    solverBidirectionalBreadthFirst,
+    solverBidirectionalDijkstraHeap,
+    solverBidirectionalDijkstraBucket,
+    solverBidirectionalAStarHeap,
+    solverBidirectionalAStarBucket,
+    solverParallelBreadthFirst,
+    solverBitboard,
+    solverBitboardScalar,
+    solverDeltaStepping,
+    solverHierarchicalBuild,
+    solverHierarchical,
+    solverLandmarkBuild,
+    solverLandmark,
+    solverFlowField
+};
+
+static const char *solverNames[] = {"dfs", "bfs", "dijkstra-heap", "dijkstra-bucket", "astar-heap", "astar-bucket", "jps",
+                                    "jps+-build", "jps+", "bibfs", "bidijkstra-heap", "bidijkstra-bucket", "biastar-heap", "biastar-bucket", "bfs-parallel",
+                                    "bfs-bitboard", "bfs-bitboard-scalar", "delta-stepping",
+                                    "hpa-build", "hpa", "alt-build", "alt", "flow-field"};
+static const int solverCount = 23;
+
+static const int defaultSizes[] = {50, 128, 256, 512, 1024, 2048, 4096, 8192};
+static const int defaultSizeCount = 8;
+
+// Edits made to the current path for the replanning comparison, each followed by one replan
+#define REPLAN_EDIT_COUNT 10
+
+// D* Lite keeps three ints per cell and its first plan costs about as much as Dijkstra, larger grids are skipped
+#define REPLAN_MAX_SIZE 2048
+
+// Landmark tables keep LANDMARK_DEFAULT_COUNT ints per cell, 128 MiB at this size, larger grids skip alt-build and alt
+#define LANDMARK_MAX_SIZE 2048
+
+// Queries in the batch throughput run, solved on a random map no larger than BATCH_MAX_SIZE
+#define BATCH_QUERY_COUNT 512
+#define BATCH_MAX_SIZE 512
+
+// Fraction of cells turned into walls and weighted cells on random obstacle maps
+#define RANDOM_WALL_CHANCE 0.25
+#define RANDOM_WEIGHT_CHANCE 0.10
+
+// Side of the square kept free of walls in the top left and bottom right corners of random obstacle maps, so the
+// endpoints are not sealed into a pocket of a few cells
+#define RANDOM_CLEAR_CORNER 3
+
+struct BenchOptions
+{
+    std::vector<int> sizes;
+    int maxSize;
+    int repeat;
+    unsigned int seed;
+    const char *jsonFile;
+    const char *label;
+    int threads;
+};
+
+struct BenchRecord
+{
+    int map;
+    int solver;
+    int size;
+    SearchResult result;
+    double milliseconds;
+    double nsPerExpansion;
+    size_t peakBytes;
+};
+
+void PrintUsage()
+{
+    printf("Usage: pv_bench [options]\n"
+           "  --sizes N,N,...       grid sizes to sweep (default 50,128,256,512,1024,2048,4096,8192)\n"
+           "  --max-size N          skip sizes larger than N\n"
+           "  --repeat N            runs per configuration, the fastest is reported (default 1)\n"
+           "  --seed N              seed for maze generation and random maps (default 1)\n"
+           "  --json FILE           also write the results as JSON\n"
+           "  --label TEXT          label stored in the JSON output, e.g. a commit hash\n"
+           "  --threads N           worker threads for the parallel solvers and batches (default one per hardware thread)\n");
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (value == NULL)
+        {
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--sizes") == 0)
+        {
+            options.sizes.clear();
+            for (const char *c = value; *c != '\0';)
+            {
+                options.sizes.push_back(atoi(c));
+                const char *comma = strchr(c, ',');
+                c = comma != NULL ? comma + 1 : c + strlen(c);
+            }
+        }
+        else if (strcmp(arg, "--max-size") == 0)
+        {
+            options.maxSize = atoi(value);
+        }
+        else if (strcmp(arg, "--repeat") == 0)
+        {
+            options.repeat = atoi(value);
+        }
+        else if (strcmp(arg, "--seed") == 0)
+        {
+            options.seed = strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--json") == 0)
+        {
+            options.jsonFile = value;
+        }
+        else if (strcmp(arg, "--label") == 0)
+        {
+            options.label = value;
+        }
+        else if (strcmp(arg, "--threads") == 0)
+        {
+            options.threads = atoi(value);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.repeat > 0;
+}
+
+void BuildMap(Grid &grid, int map, int size, unsigned int seed)
+{
+    grid.Resize(size, size);
+    SetAlgorithmSeed(seed);
+
+    switch (map)
+    {
+    case mapPrim:
+        grid.Fill(true);
+        GenerateMaze(mazePrim, grid);
+        break;
+    case mapDfs:
+        grid.Fill(true);
+        GenerateMaze(mazeDfs, grid);
+        break;
+    case mapSidewinder:
+        grid.Fill(true);
+        GenerateMaze(mazeSidewinder, grid);
+        break;
+    case mapOpen:
+        break;
+    case mapRandom:
+    {
+        std::mt19937 engine(seed);
+        std::uniform_real_distribution<double> chance(0, 1);
+
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                double roll = chance(engine);
+                int index = grid.Index(x, y);
+                bool corner = (x < RANDOM_CLEAR_CORNER && y < RANDOM_CLEAR_CORNER) ||
+                              (x >= size - RANDOM_CLEAR_CORNER && y >= size - RANDOM_CLEAR_CORNER);
+
+                if (roll < RANDOM_WALL_CHANCE && !corner)
+                {
+                    grid.SetWall(index, true);
+                }
+                else if (roll < RANDOM_WALL_CHANCE + RANDOM_WEIGHT_CHANCE)
+                {
+                    grid.SetWeighted(index, true);
+                }
+            }
+        }
+        break;
+    }
+    }
+}
+
+// First open cell from the top left corner, or -1 when every cell is a wall
+int StartCell(const Grid &grid)
+{
+    int cells = grid.rows * grid.cols;
+
+    for (int cell = 0; cell < cells; cell++)
+    {
+        int index = grid.Index(cell % grid.cols, cell / grid.cols);
+
+        if (!grid.IsWall(index))
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Open cell closest to the bottom right corner that the start can reach. Random maps can wall the corner off, and
+// comparing two searches that both find nothing says nothing about either
+int EndCell(const Grid &grid, int startIndex)
+{
+    if (startIndex == -1)
+    {
+        return -1;
+    }
+
+    std::vector<bool> reached(grid.Size(), false);
+    std::vector<int> queue(1, startIndex);
+    reached[startIndex] = true;
+
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            int neighbourIndex = queue[i] + grid.offsets[j];
+
+            if (!grid.IsWall(neighbourIndex) && !reached[neighbourIndex])
+            {
+                reached[neighbourIndex] = true;
+                queue.push_back(neighbourIndex);
+            }
+        }
+    }
+
+    for (int cell = grid.rows * grid.cols - 1; cell >= 0; cell--)
+    {
+        int index = grid.Index(cell % grid.cols, cell / grid.cols);
+
+        if (reached[index])
+        {
+            return index;
+        }
+    }
+    return startIndex;
+}
+
+SearchResult RunSolver(Grid &grid, int solver, int startIndex, int endIndex)
+{
+    switch (solver)
+    {
+    case solverDepthFirstSearch:
+        return RunSearch(searchDepthFirst, grid, startIndex, endIndex);
+    case solverBreadthFirstSearch:
+        return RunSearch(searchBreadthFirst, grid, startIndex, endIndex);
+    case solverDijkstraHeap:
+        return RunSearch(searchDijkstra, grid, startIndex, endIndex, queueBinaryHeap);
+    case solverDijkstraBucket:
+        return RunSearch(searchDijkstra, grid, startIndex, endIndex, queueBucket);
+    case solverAStarHeap:
+        return RunSearch(searchAStar, grid, startIndex, endIndex, queueBinaryHeap);
+    case solverAStarBucket:
+        return RunSearch(searchAStar, grid, startIndex, endIndex, queueBucket);
+    case solverJumpPoint:
+        return RunSearch(searchJumpPoint, grid, startIndex, endIndex);
+    case solverJumpPointPlusBuild:
+        jumpTable.Build(grid);
+        return RunJumpPointPlusSearch(jumpTable, grid, startIndex, endIndex);
+    case solverJumpPointPlus:
+        return RunJumpPointPlusSearch(jumpTable, grid, startIndex, endIndex);
+    case solverBidirectionalBreadthFirst:
+        return RunSearch(searchBidirectionalBreadthFirst, grid, startIndex, endIndex);
+    case solverBidirectionalDijkstraHeap:
+        return RunSearch(searchBidirectionalDijkstra, grid, startIndex, endIndex, queueBinaryHeap);
+    case solverBidirectionalDijkstraBucket:
+        return RunSearch(searchBidirectionalDijkstra, grid, startIndex, endIndex, queueBucket);
+    case solverBidirectionalAStarHeap:
+        return RunSearch(searchBidirectionalAStar, grid, startIndex, endIndex, queueBinaryHeap);
+    case solverBidirectionalAStarBucket:
+        return RunSearch(searchBidirectionalAStar, grid, startIndex, endIndex, queueBucket);
+    case solverParallelBreadthFirst:
+        return ParallelBreadthFirstSearch(*threadPool, grid, startIndex, endIndex);
+    case solverBitboard:
+        return BitboardBreadthFirstSearch(grid, startIndex, endIndex);
+    case solverBitboardScalar:
+        return BitboardBreadthFirstSearch(grid, startIndex, endIndex, bitboardScalar);
+    case solverDeltaStepping:
+        return DeltaSteppingSearch(*threadPool, grid, startIndex, endIndex);
+    case solverHierarchicalBuild:
+        hierarchy.Build(grid, threadPool);
+        return hierarchy.Search(grid, startIndex, endIndex);
+    case solverHierarchical:
+        return hierarchy.Search(grid, startIndex, endIndex);
+    case solverLandmarkBuild:
+        landmarkTable.Build(grid);
+        return RunLandmarkSearch(landmarkTable, grid, startIndex, endIndex);
+    case solverLandmark:
+        return RunLandmarkSearch(landmarkTable, grid, startIndex, endIndex);
+    case solverFlowField:
+    {
+        // Builds the whole field and follows it once, expansions count the cells that reach the end
+        FlowField field;
+        long long reached = field.Build(grid, endIndex);
+        SearchResult result = field.Follow(grid, startIndex);
+        result.expansions = reached;
+        return result;
+    }
+    }
+    return {false, 0, 0, 0};
+}
+
+BenchRecord RunBenchmark(Grid &grid, int map, int solver, int size, int repeat)
+{
+    BenchRecord record = {map, solver, size, {false, 0, 0, 0}, 0, 0, 0};
+    int startIndex = StartCell(grid);
+    int endIndex = EndCell(grid, startIndex);
+
+    for (int i = 0; i < repeat; i++)
+    {
+        grid.ResetStates();
+
+        size_t baseline = currentBytes.load();
+        peakBytes.store(baseline);
+        auto start = std::chrono::steady_clock::now();
+
+        SearchResult result = RunSolver(grid, solver, startIndex, endIndex);
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (i == 0 || elapsed.count() < record.milliseconds)
+        {
+            record.result = result;
+            record.milliseconds = elapsed.count();
+            record.peakBytes = peakBytes - baseline;
+        }
+    }
+
+    if (record.result.expansions > 0)
+    {
+        record.nsPerExpansion = record.milliseconds * 1e6 / record.result.expansions;
+    }
+    return record;
+}
+
+// Checks every delta-stepping run against the Dijkstra run on the same map and prints its speedup,
+// returns the number of runs whose path cost differs or whose reference found no path
+int PrintDeltaSteppingSummary(const std::vector<BenchRecord> &records)
+{
+    int mismatches = 0;
+
+    printf("\n%-10s %6s %10s %10s %10s %10s %8s\n", "map", "size", "cost", "dijk cost", "delta ms", "dijk ms", "speedup");
+
+    for (const BenchRecord &record : records)
+    {
+        if (record.solver != solverDeltaStepping)
+        {
+            continue;
+        }
+
+        for (const BenchRecord &reference : records)
+        {
+            if (reference.solver != solverDijkstraHeap || reference.map != record.map || reference.size != record.size)
+            {
+                continue;
+            }
+
+            // Endpoints are always connected, so a reference without a path fails the check instead of matching one
+            bool match = reference.result.found && record.result.found && record.result.pathCost == reference.result.pathCost;
+            mismatches += match ? 0 : 1;
+
+            printf("%-10s %6d %10d %10d %10.3f %10.3f %7.2fx%s\n", mapNames[record.map], record.size, record.result.pathCost,
+                   reference.result.pathCost, record.milliseconds, reference.milliseconds,
+                   record.milliseconds > 0 ? reference.milliseconds / record.milliseconds : 0.0,
+                   !reference.result.found ? "  NO PATH" : match ? "" : "  MISMATCH");
+        }
+    }
+    return mismatches;
+}
+
+// Checks every alt run against the Dijkstra run on the same map and compares its expansions with plain A*,
+// returns the number of runs whose path cost differs or whose reference found no path
+int PrintLandmarkSummary(const std::vector<BenchRecord> &records)
+{
+    int mismatches = 0;
+
+    printf("\n%-10s %6s %10s %10s %12s %12s %8s\n", "map", "size", "cost", "dijk cost", "alt exp", "astar exp", "saved");
+
+    for (const BenchRecord &record : records)
+    {
+        if (record.solver != solverLandmark)
+        {
+            continue;
+        }
+
+        const BenchRecord *dijkstra = NULL;
+        const BenchRecord *astar = NULL;
+
+        for (const BenchRecord &reference : records)
+        {
+            if (reference.map == record.map && reference.size == record.size)
+            {
+                dijkstra = reference.solver == solverDijkstraHeap ? &reference : dijkstra;
+                astar = reference.solver == solverAStarBucket ? &reference : astar;
+            }
+        }
+        if (dijkstra == NULL || astar == NULL)
+        {
+            continue;
+        }
+
+        bool match = dijkstra->result.found && record.result.found && record.result.pathCost == dijkstra->result.pathCost;
+        mismatches += match ? 0 : 1;
+
+        printf("%-10s %6d %10d %10d %12lld %12lld %7.2f%%%s\n", mapNames[record.map], record.size, record.result.pathCost,
+               dijkstra->result.pathCost, record.result.expansions, astar->result.expansions,
+               astar->result.expansions > 0 ? 100.0 - 100.0 * record.result.expansions / astar->result.expansions : 0.0,
+               !dijkstra->result.found ? "  NO PATH" : match ? "" : "  MISMATCH");
+    }
+    return mismatches;
+}
+
+// Times a batch of random A* queries solved one after another, then with SolveBatch on 1, 2, 4 and so on up to the
+// pool's worker count, and once more from a warm path cache. Returns the number of batch results that differ from the sequential ones
+int PrintBatchScaling(const BenchOptions &options, Grid &grid)
+{
+    int size = 0;
+
+    for (int candidate : options.sizes)
+    {
+        if (candidate >= 2 && candidate <= BATCH_MAX_SIZE && (options.maxSize == 0 || candidate <= options.maxSize))
+        {
+            size = std::max(size, candidate);
+        }
+    }
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    BuildMap(grid, mapRandom, size, options.seed);
+
+    std::vector<int> openCells;
+    for (int index = 0; index < grid.Size(); index++)
+    {
+        if (!grid.IsWall(index))
+        {
+            openCells.push_back(index);
+        }
+    }
+
+    std::mt19937 engine(options.seed);
+    std::uniform_int_distribution<int> pick(0, openCells.size() - 1);
+    std::vector<BatchQuery> queries(BATCH_QUERY_COUNT);
+
+    for (BatchQuery &query : queries)
+    {
+        query.startIndex = openCells[pick(engine)];
+        query.endIndex = openCells[pick(engine)];
+    }
+
+    std::vector<SearchResult> expected(queries.size());
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        expected[i] = RunSearch(searchAStar, grid, queries[i].startIndex, queries[i].endIndex);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    double sequentialMilliseconds = elapsed.count();
+    int mismatches = 0;
+
+    printf("\n%-10s %6s %8s %8s %10s %12s %8s\n", "map", "size", "queries", "threads", "ms", "queries/s", "speedup");
+    printf("%-10s %6d %8zu %8s %10.3f %12.1f %7.2fx\n", mapNames[mapRandom], size, queries.size(), "serial", sequentialMilliseconds,
+           queries.size() * 1000.0 / sequentialMilliseconds, 1.0);
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < threadPool->Size(); threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(threadPool->Size());
+
+    for (int threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<SearchResult> results = SolveBatch(pool, grid, queries, searchAStar);
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            mismatches += results[i].found == expected[i].found && results[i].pathCost == expected[i].pathCost ? 0 : 1;
+        }
+
+        printf("%-10s %6d %8zu %8d %10.3f %12.1f %7.2fx\n", mapNames[mapRandom], size, queries.size(), threads, elapsed.count(),
+               queries.size() * 1000.0 / elapsed.count(), sequentialMilliseconds / elapsed.count());
+    }
+
+    // The same batch again from a warm path cache, every query is a hit
+    PathCache cache(queries.size());
+    SolveBatch(*threadPool, grid, queries, searchAStar, queueAuto, &cache);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<SearchResult> cached = SolveBatch(*threadPool, grid, queries, searchAStar, queueAuto, &cache);
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        mismatches += cached[i].found == expected[i].found && cached[i].pathCost == expected[i].pathCost ? 0 : 1;
+    }
+
+    printf("%-10s %6d %8zu %8s %10.3f %12.1f %7.2fx  %lld hits, %lld misses\n", mapNames[mapRandom], size, queries.size(), "cached",
+           elapsed.count(), queries.size() * 1000.0 / elapsed.count(), sequentialMilliseconds / elapsed.count(), cache.hits, cache.misses);
+
+    // HPA* over the whole pool, its paths can cost more than A* but never less and must be found just the same
+    HierarchicalGraph graph;
+    start = std::chrono::steady_clock::now();
+    graph.Build(grid, threadPool);
+    std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<SearchResult> abstract = SolveBatch(*threadPool, graph, grid, queries);
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        mismatches += abstract[i].found == expected[i].found && abstract[i].pathCost >= expected[i].pathCost ? 0 : 1;
+    }
+
+    printf("%-10s %6d %8zu %8s %10.3f %12.1f %7.2fx  %d threads, built in %.3f ms\n", mapNames[mapRandom], size, queries.size(), "hpa",
+           elapsed.count(), queries.size() * 1000.0 / elapsed.count(), sequentialMilliseconds / elapsed.count(), threadPool->Size(),
+           buildTime.count());
+    return mismatches;
+}
+
+// Edits the current path again and again, replanning D* Lite after every edit and timing a fresh A* on the same grid.
+// Edits alternate between opening a wall next to the path, which may give a shortcut, and walling off the middle of the
+// path, which forces a detour. Returns the number of replans whose path cost differs from A* plus the maps with no first path
+int PrintReplanComparison(const BenchOptions &options, Grid &grid)
+{
+    int mismatches = 0;
+
+    printf("\n%-10s %6s %6s %12s %12s %8s %10s %10s\n", "map", "size", "edits", "dstar exp", "astar exp", "touched", "dstar ms",
+           "astar ms");
+
+    for (int size : options.sizes)
+    {
+        if (size < 2 || size > REPLAN_MAX_SIZE || (options.maxSize > 0 && size > options.maxSize))
+        {
+            continue;
+        }
+
+        for (int map = 0; map < mapCount; map++)
+        {
+            BuildMap(grid, map, size, options.seed);
+
+            int startIndex = StartCell(grid);
+            int endIndex = EndCell(grid, startIndex);
+            DStarLite planner;
+            std::vector<int> path;
+
+            // The end is reachable by construction, a first plan without a path is a planner bug
+            if (!planner.Plan(grid, startIndex, endIndex, &path).found)
+            {
+                printf("%-10s %6d  NO PATH\n", mapNames[map], size);
+                mismatches++;
+                continue;
+            }
+
+            long long replanExpansions = 0;
+            long long searchExpansions = 0;
+            double replanMilliseconds = 0;
+            double searchMilliseconds = 0;
+            int edits = 0;
+
+            // Paths of two cells have no middle to wall off
+            while (edits < REPLAN_EDIT_COUNT && path.size() > 2)
+            {
+                int index = path[path.size() / 2];
+                bool wall = true;
+
+                for (size_t i = path.size() / 2; edits % 2 == 0 && wall && i < path.size(); i++)
+                {
+                    for (int j = 0; j < 4 && wall; j++)
+                    {
+                        int neighbourIndex = path[i] + grid.offsets[j];
+
+                        if (grid.IsWall(neighbourIndex) && !grid.IsBorder(neighbourIndex))
+                        {
+                            index = neighbourIndex;
+                            wall = false;
+                        }
+                    }
+                }
+
+                grid.SetWall(index, wall);
+                planner.CellChanged(index);
+                edits++;
+
+                auto start = std::chrono::steady_clock::now();
+                SearchResult replan = planner.Plan(grid, startIndex, endIndex, &path);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                replanMilliseconds += elapsed.count();
+
+                start = std::chrono::steady_clock::now();
+                SearchResult search = RunSearch(searchAStar, grid, startIndex, endIndex);
+                elapsed = std::chrono::steady_clock::now() - start;
+                searchMilliseconds += elapsed.count();
+
+                replanExpansions += replan.expansions;
+                searchExpansions += search.expansions;
+                mismatches += replan.found == search.found && replan.pathCost == search.pathCost ? 0 : 1;
+            }
+
+            if (edits == 0)
+            {
+                continue;
+            }
+
+            printf("%-10s %6d %6d %12lld %12lld %7.2f%% %10.3f %10.3f\n", mapNames[map], size, edits, replanExpansions / edits,
+                   searchExpansions / edits, searchExpansions > 0 ? 100.0 * replanExpansions / searchExpansions : 0.0,
+                   replanMilliseconds / edits, searchMilliseconds / edits);
+        }
+    }
+    return mismatches;
+}
+
+bool WriteJson(const char *fileName, const BenchOptions &options, const std::vector<BenchRecord> &records)
+{
+    FILE *file = fopen(fileName, "w");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"label\": \"%s\",\n  \"seed\": %u,\n  \"repeat\": %d,\n  \"results\": [\n", options.label, options.seed, options.repeat);
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const BenchRecord &record = records[i];
+
+        fprintf(file,
+                "    {\"map\": \"%s\", \"solver\": \"%s\", \"size\": %d, \"found\": %s, \"pathLength\": %d, \"pathCost\": %d, "
+                "\"expansions\": %lld, \"totalMs\": %.4f, \"nsPerExpansion\": %.2f, \"peakBytes\": %zu}%s\n",
+                mapNames[record.map], solverNames[record.solver], record.size, record.result.found ? "true" : "false",
+                record.result.pathLength, record.result.pathCost, record.result.expansions, record.milliseconds,
+                record.nsPerExpansion, record.peakBytes, i + 1 < records.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    options.sizes.assign(defaultSizes, defaultSizes + defaultSizeCount);
+    options.maxSize = 0;
+    options.repeat = 1;
+    options.seed = 1;
+    options.jsonFile = NULL;
+    options.label = "";
+    options.threads = 0;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<BenchRecord> records;
+    Grid grid = {0};
+    ThreadPool pool(options.threads);
+    threadPool = &pool;
+
+    printf("%-10s %-18s %6s %6s %10s %10s %12s %10s %12s\n", "map", "solver", "size", "found", "path", "cost", "expansions", "ms", "ns/exp");
+
+    for (int size : options.sizes)
+    {
+        if (size < 2 || (options.maxSize > 0 && size > options.maxSize))
+        {
+            continue;
+        }
+
+        for (int map = 0; map < mapCount; map++)
+        {
+            BuildMap(grid, map, size, options.seed);
+
+            for (int solver = 0; solver < solverCount; solver++)
+            {
+                if ((solver == solverLandmarkBuild || solver == solverLandmark) && size > LANDMARK_MAX_SIZE)
+                {
+                    continue;
+                }
+
+                BenchRecord record = RunBenchmark(grid, map, solver, size, options.repeat);
+                records.push_back(record);
+
+                printf("%-10s %-18s %6d %6s %10d %10d %12lld %10.3f %12.2f  peak %zu KiB\n", mapNames[map], solverNames[solver], size,
+                       record.result.found ? "yes" : "no", record.result.pathLength, record.result.pathCost,
+                       record.result.expansions, record.milliseconds, record.nsPerExpansion, record.peakBytes / 1024);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (options.jsonFile != NULL && !WriteJson(options.jsonFile, options, records))
+    {
+        fprintf(stderr, "Could not write %s\n", options.jsonFile);
+        return 1;
+    }
+
+    if (PrintDeltaSteppingSummary(records) > 0)
+    {
+        fprintf(stderr, "Delta-stepping disagrees with Dijkstra\n");
+        return 1;
+    }
+    if (PrintLandmarkSummary(records) > 0)
+    {
+        fprintf(stderr, "ALT disagrees with Dijkstra\n");
+        return 1;
+    }
+    if (PrintBatchScaling(options, grid) > 0)
+    {
+        fprintf(stderr, "Batch results disagree with sequential A*\n");
+        return 1;
+    }
+    if (PrintReplanComparison(options, grid) > 0)
+    {
+        fprintf(stderr, "D* Lite disagrees with A*\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,356 @@
+#include "pv_bitboard.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITBOARD_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+// Words expanded together, one AVX2 register
+#define BITBOARD_BLOCK_WORDS 4
+
+// Frontiers with at least one active block per this many blocks of their span sweep the whole span instead
+#define BITBOARD_DENSE_SPAN 8
+
+// Bitsets of the search, offset by guard words on both sides so the row shifts can read past either end of the grid.
+// Guard words are visited and never in the frontier. Only blocks next to the frontier are expanded, so sparse
+// frontiers like the branches of a maze do not rescan the rows between them
+struct Bitboard
+{
+    int words;
+    int guard;
+    int firstBlock;
+    int lastBlock;
+    // A row is rowWords whole words plus rowBits bits
+    int rowWords;
+    int rowBits;
+
+    std::vector<uint64_t> frontier;
+    std::vector<uint64_t> next;
+    std::vector<uint64_t> visited;
+    // Level modulo 3 plus one of every reached cell, split into its low and high bit
+    std::vector<uint64_t> levelLow;
+    std::vector<uint64_t> levelHigh;
+
+    // Blocks holding frontier cells, and the blocks they can reach this level
+    std::vector<int> active;
+    std::vector<int> nextActive;
+    std::vector<int> candidates;
+    std::vector<uint8_t> scheduled;
+
+    // Queues the blocks covering words [first, last] for expansion
+    void ScheduleWords(int first, int last)
+    {
+        int firstCandidate = first / BITBOARD_BLOCK_WORDS;
+        int lastCandidate = last / BITBOARD_BLOCK_WORDS;
+        firstCandidate = firstCandidate < firstBlock ? firstBlock : firstCandidate;
+        lastCandidate = lastCandidate > lastBlock ? lastBlock : lastCandidate;
+
+        for (int block = firstCandidate; block <= lastCandidate; block++)
+        {
+            if (!scheduled[block])
+            {
+                scheduled[block] = 1;
+                candidates.push_back(block);
+            }
+        }
+    }
+
+    // Queues every block from the first to the last active one, plus a row on either side
+    bool ScheduleSpan()
+    {
+        int first = lastBlock;
+        int last = firstBlock;
+
+        for (int block : active)
+        {
+            first = block < first ? block : first;
+            last = block > last ? block : last;
+        }
+
+        int rowBlocks = rowWords / BITBOARD_BLOCK_WORDS + 1;
+        first = first - rowBlocks < firstBlock ? firstBlock : first - rowBlocks;
+        last = last + rowBlocks > lastBlock ? lastBlock : last + rowBlocks;
+
+        if (last - first + 1 > (long long)active.size() * BITBOARD_DENSE_SPAN)
+        {
+            return false;
+        }
+
+        for (int block = first; block <= last; block++)
+        {
+            candidates.push_back(block);
+        }
+        return true;
+    }
+
+    // A frontier word reaches the words beside it and the words one row up and down, a row being rowWords words
+    // plus rowBits bits, so a shifted word spills into the word after it
+    void ScheduleNeighbours(int block)
+    {
+        int first = block * BITBOARD_BLOCK_WORDS;
+        int last = first + BITBOARD_BLOCK_WORDS - 1;
+
+        ScheduleWords(first - 1, last + 1);
+        ScheduleWords(first - rowWords - 1, last - rowWords);
+        ScheduleWords(first + rowWords, last + rowWords + 1);
+    }
+
+    bool Test(const std::vector<uint64_t> &bits, int index) const
+    {
+        return (bits[guard + (index >> 6)] >> (index & 63)) & 1;
+    }
+
+    void Set(std::vector<uint64_t> &bits, int index)
+    {
+        bits[guard + (index >> 6)] |= 1ULL << (index & 63);
+    }
+
+    int LevelMark(int index) const
+    {
+        return Test(levelLow, index) | (Test(levelHigh, index) << 1);
+    }
+};
+
+// Expands the candidate blocks into next, blocks with newly reached cells are added to nextActive
+typedef void (*ExpandLevel)(Bitboard &board, int mark);
+
+static void ExpandLevelScalar(Bitboard &board, int mark)
+{
+    const uint64_t *frontier = board.frontier.data();
+    uint64_t *next = board.next.data();
+    uint64_t *visited = board.visited.data();
+    uint64_t *levelLow = board.levelLow.data();
+    uint64_t *levelHigh = board.levelHigh.data();
+
+    int q = board.rowWords;
+    int r = board.rowBits;
+    uint64_t lowMask = mark & 1 ? ~0ULL : 0;
+    uint64_t highMask = mark & 2 ? ~0ULL : 0;
+
+    for (int block : board.candidates)
+    {
+        uint64_t any = 0;
+
+        for (int w = block * BITBOARD_BLOCK_WORDS; w < (block + 1) * BITBOARD_BLOCK_WORDS; w++)
+        {
+            uint64_t right = (frontier[w] << 1) | (frontier[w - 1] >> 63);
+            uint64_t left = (frontier[w] >> 1) | (frontier[w + 1] << 63);
+
+            // The carried part is shifted in two steps so a row of whole words carries nothing instead of shifting by 64
+            uint64_t down = (frontier[w - q] << r) | ((frontier[w - q - 1] >> 1) >> (63 - r));
+            uint64_t up = (frontier[w + q] >> r) | ((frontier[w + q + 1] << 1) << (63 - r));
+
+            uint64_t reached = (right | left | down | up) & ~visited[w];
+            next[w] = reached;
+
+            visited[w] |= reached;
+            levelLow[w] |= reached & lowMask;
+            levelHigh[w] |= reached & highMask;
+            any |= reached;
+        }
+
+        if (any != 0)
+        {
+            board.nextActive.push_back(block);
+        }
+    }
+}
+
+#ifdef BITBOARD_HAS_AVX2
+// Same as the scalar loop four words at a time, the neighbouring words come from unaligned loads one word over
+__attribute__((target("avx2"))) static void ExpandLevelAvx2(Bitboard &board, int mark)
+{
+    const uint64_t *frontier = board.frontier.data();
+    uint64_t *next = board.next.data();
+    uint64_t *visited = board.visited.data();
+    uint64_t *levelLow = board.levelLow.data();
+    uint64_t *levelHigh = board.levelHigh.data();
+
+    int q = board.rowWords;
+    __m128i one = _mm_cvtsi32_si128(1);
+    __m128i sixtyThree = _mm_cvtsi32_si128(63);
+    // AVX2 shifts of 64 or more give zero, so a row of whole words needs no special case
+    __m128i rowShift = _mm_cvtsi32_si128(board.rowBits);
+    __m128i carryShift = _mm_cvtsi32_si128(64 - board.rowBits);
+    __m256i lowMask = _mm256_set1_epi64x(mark & 1 ? -1 : 0);
+    __m256i highMask = _mm256_set1_epi64x(mark & 2 ? -1 : 0);
+
+    for (int block : board.candidates)
+    {
+        int w = block * BITBOARD_BLOCK_WORDS;
+        __m256i center = _mm256_loadu_si256((const __m256i *)(frontier + w));
+        __m256i right = _mm256_or_si256(_mm256_sll_epi64(center, one), _mm256_srl_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w - 1)), sixtyThree));
+        __m256i left = _mm256_or_si256(_mm256_srl_epi64(center, one), _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w + 1)), sixtyThree));
+        __m256i down = _mm256_or_si256(_mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w - q)), rowShift),
+                                       _mm256_srl_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w - q - 1)), carryShift));
+        __m256i up = _mm256_or_si256(_mm256_srl_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w + q)), rowShift),
+                                     _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(frontier + w + q + 1)), carryShift));
+
+        __m256i seen = _mm256_loadu_si256((const __m256i *)(visited + w));
+        __m256i reached = _mm256_andnot_si256(seen, _mm256_or_si256(_mm256_or_si256(right, left), _mm256_or_si256(down, up)));
+        _mm256_storeu_si256((__m256i *)(next + w), reached);
+
+        if (!_mm256_testz_si256(reached, reached))
+        {
+            _mm256_storeu_si256((__m256i *)(visited + w), _mm256_or_si256(seen, reached));
+
+            __m256i low = _mm256_loadu_si256((const __m256i *)(levelLow + w));
+            __m256i high = _mm256_loadu_si256((const __m256i *)(levelHigh + w));
+            _mm256_storeu_si256((__m256i *)(levelLow + w), _mm256_or_si256(low, _mm256_and_si256(reached, lowMask)));
+            _mm256_storeu_si256((__m256i *)(levelHigh + w), _mm256_or_si256(high, _mm256_and_si256(reached, highMask)));
+
+            board.nextActive.push_back(block);
+        }
+    }
+}
+#endif
+
+static bool CpuSupportsAvx2()
+{
+#ifdef BITBOARD_HAS_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+BitboardEngine ResolveBitboardEngine(BitboardEngine engine)
+{
+    if (engine == bitboardScalar || !CpuSupportsAvx2())
+    {
+        return bitboardScalar;
+    }
+    return bitboardAvx2;
+}
+
+const char *BitboardEngineName(BitboardEngine engine)
+{
+    switch (engine)
+    {
+    case bitboardAuto:
+        return "auto";
+    case bitboardScalar:
+        return "scalar";
+    case bitboardAvx2:
+        return "avx2";
+    }
+    return "";
+}
+
+SearchResult BitboardBreadthFirstSearch(const Grid &grid, int startIndex, int endIndex, BitboardEngine engine)
+{
+    SearchResult result = {false, 0, 0, 0};
+
+    if (grid.IsWall(startIndex) || grid.IsWall(endIndex))
+    {
+        return result;
+    }
+
+    ExpandLevel expand = ExpandLevelScalar;
+#ifdef BITBOARD_HAS_AVX2
+    if (ResolveBitboardEngine(engine) == bitboardAvx2)
+    {
+        expand = ExpandLevelAvx2;
+    }
+#endif
+
+    Bitboard board;
+    board.words = grid.walls.size();
+    board.rowWords = grid.stride / 64;
+    board.rowBits = grid.stride % 64;
+
+    // Room for the row shifts on either side, in whole blocks
+    board.guard = (board.rowWords + 2 + BITBOARD_BLOCK_WORDS) / BITBOARD_BLOCK_WORDS * BITBOARD_BLOCK_WORDS;
+    int total = board.guard + (board.words + BITBOARD_BLOCK_WORDS - 1) / BITBOARD_BLOCK_WORDS * BITBOARD_BLOCK_WORDS + board.guard;
+    board.firstBlock = board.guard / BITBOARD_BLOCK_WORDS;
+    board.lastBlock = (board.guard + board.words - 1) / BITBOARD_BLOCK_WORDS;
+    board.scheduled.assign(total / BITBOARD_BLOCK_WORDS, 0);
+
+    board.frontier.assign(total, 0);
+    board.next.assign(total, 0);
+    board.visited.assign(total, ~0ULL);
+    board.levelLow.assign(total, 0);
+    board.levelHigh.assign(total, 0);
+
+    // Walls and the border start out visited, as do the bits past the last cell
+    std::copy(grid.walls.begin(), grid.walls.end(), board.visited.begin() + board.guard);
+    if (grid.Size() % 64 != 0)
+    {
+        board.visited[board.guard + board.words - 1] |= ~0ULL << (grid.Size() % 64);
+    }
+
+    long long blocked = 0;
+    for (int w = 0; w < board.words; w++)
+    {
+        blocked += __builtin_popcountll(board.visited[board.guard + w]);
+    }
+
+    board.Set(board.frontier, startIndex);
+    board.Set(board.visited, startIndex);
+    board.Set(board.levelLow, startIndex);
+    board.active.push_back((board.guard + (startIndex >> 6)) / BITBOARD_BLOCK_WORDS);
+
+    for (int level = 1; !board.active.empty() && !board.Test(board.visited, endIndex); level++)
+    {
+        if (!board.ScheduleSpan())
+        {
+            for (int block : board.active)
+            {
+                board.ScheduleNeighbours(block);
+            }
+        }
+
+        expand(board, level % 3 + 1);
+
+        // Clear the expanded frontier so the buffer comes back empty as the next level's output
+        for (int block : board.candidates)
+        {
+            board.scheduled[block] = 0;
+        }
+        for (int block : board.active)
+        {
+            std::fill(&board.frontier[block * BITBOARD_BLOCK_WORDS], &board.frontier[(block + 1) * BITBOARD_BLOCK_WORDS], 0);
+        }
+        board.candidates.clear();
+        board.active.swap(board.nextActive);
+        board.nextActive.clear();
+        board.frontier.swap(board.next);
+    }
+
+    for (int w = 0; w < board.words; w++)
+    {
+        result.expansions += __builtin_popcountll(board.visited[board.guard + w]);
+    }
+    result.expansions -= blocked;
+
+    if (!board.Test(board.visited, endIndex))
+    {
+        return result;
+    }
+
+    // Walk back from the end through neighbours one level closer to the start
+    result.found = true;
+    int index = endIndex;
+
+    while (index != startIndex)
+    {
+        int previousMark = (board.LevelMark(index) + 1) % 3 + 1;
+
+        for (int i = 0; i < 4; i++)
+        {
+            int neighbourIndex = index + grid.offsets[i];
+            if (!grid.IsWall(neighbourIndex) && board.LevelMark(neighbourIndex) == previousMark)
+            {
+                result.pathLength++;
+                result.pathCost += grid.costs[index];
+                index = neighbourIndex;
+                break;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,24 @@
+#ifndef PV_BITBOARD_H
+#define PV_BITBOARD_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+
+// Word loop used to expand a bitboard BFS level
+enum BitboardEngine
+{
+    bitboardAuto,
+    bitboardScalar,
+    bitboardAvx2
+};
+
+// Engine that actually runs for a request, auto and unsupported requests fall back to what the CPU supports
+BitboardEngine ResolveBitboardEngine(BitboardEngine engine);
+const char *BitboardEngineName(BitboardEngine engine);
+
+// BFS on the wall bitset of an unweighted grid. A whole level is expanded at once by shifting the frontier bitset
+// one cell and one row each way and masking out visited cells, 64 cells per word or 256 per AVX2 register.
+// Every cell keeps its level modulo 3 in two bit planes, enough to walk the path back from the end
+SearchResult BitboardBreadthFirstSearch(const Grid &grid, int startIndex, int endIndex, BitboardEngine engine = bitboardAuto);
+
+#endif
@@ -0,0 +1,122 @@
+#include "pv_cache.h"
+
+bool PackPath(const Grid &grid, const std::vector<int> &path, std::vector<uint8_t> &moves)
+{
+    int moveCount = path.empty() ? 0 : path.size() - 1;
+    moves.assign((moveCount + 3) / 4, 0);
+
+    for (int i = 0; i < moveCount; i++)
+    {
+        int offset = path[i + 1] - path[i];
+        int direction = 0;
+
+        while (direction < 4 && grid.offsets[direction] != offset)
+        {
+            direction++;
+        }
+        if (direction == 4)
+        {
+            return false;
+        }
+        moves[i >> 2] |= direction << ((i & 3) * 2);
+    }
+    return true;
+}
+
+void UnpackPath(const Grid &grid, int startIndex, const std::vector<uint8_t> &moves, int moveCount, std::vector<int> &path)
+{
+    int index = startIndex;
+
+    path.clear();
+    path.reserve(moveCount + 1);
+    path.push_back(index);
+
+    for (int i = 0; i < moveCount; i++)
+    {
+        index += grid.offsets[(moves[i >> 2] >> ((i & 3) * 2)) & 3];
+        path.push_back(index);
+    }
+}
+
+void PathCache::Advance(uint64_t generation)
+{
+    if (generation != this->generation)
+    {
+        this->generation = generation;
+        entries.clear();
+        lookup.clear();
+    }
+}
+
+bool PathCache::Find(const Grid &grid, int startIndex, int endIndex, int algorithm, SearchResult &result, std::vector<int> *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Advance(grid.generation);
+
+    auto found = lookup.find({grid.generation, startIndex, endIndex, algorithm});
+    if (found == lookup.end() || (path != NULL && !found->second->hasPath))
+    {
+        misses++;
+        return false;
+    }
+
+    // Move to the front, the list keeps its nodes so the iterator stays valid
+    entries.splice(entries.begin(), entries, found->second);
+
+    const PathCacheEntry &entry = entries.front();
+    result = entry.result;
+    if (path != NULL && entry.result.found)
+    {
+        UnpackPath(grid, startIndex, entry.moves, entry.result.pathLength, *path);
+    }
+    else if (path != NULL)
+    {
+        path->clear();
+    }
+    hits++;
+    return true;
+}
+
+void PathCache::Insert(const Grid &grid, int startIndex, int endIndex, int algorithm, const SearchResult &result, const std::vector<int> *path)
+{
+    PathCacheEntry entry = {{grid.generation, startIndex, endIndex, algorithm}, result, path != NULL, {}};
+
+    // Packed outside the lock, an entry whose path is not a chain of neighbours keeps only its result
+    if (path != NULL && !path->empty())
+    {
+        entry.hasPath = PackPath(grid, *path, entry.moves) && (int)path->size() == result.pathLength + 1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Advance(grid.generation);
+
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    auto found = lookup.find(entry.key);
+    if (found != lookup.end())
+    {
+        entries.erase(found->second);
+        lookup.erase(found);
+    }
+
+    entries.push_front(std::move(entry));
+    lookup[entries.front().key] = entries.begin();
+
+    if (entries.size() > capacity)
+    {
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void PathCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lookup.clear();
+    hits = 0;
+    misses = 0;
+}
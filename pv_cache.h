@@ -0,0 +1,86 @@
+#ifndef PV_CACHE_H
+#define PV_CACHE_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+
+#include <list>
+#include <mutex>
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+
+// Solved queries kept when no capacity is given
+#define PATH_CACHE_DEFAULT_CAPACITY 4096
+
+// A query is only answered from the cache for the grid generation it was solved on. Algorithm is any id the caller
+// keeps apart, like a SearchType, since different searches can return different paths of the same cost
+struct PathCacheKey
+{
+    uint64_t generation;
+    int startIndex;
+    int endIndex;
+    int algorithm;
+
+    bool operator==(const PathCacheKey &other) const
+    {
+        return generation == other.generation && startIndex == other.startIndex && endIndex == other.endIndex && algorithm == other.algorithm;
+    }
+};
+
+struct PathCacheKeyHash
+{
+    size_t operator()(const PathCacheKey &key) const
+    {
+        uint64_t hash = key.generation * 0x9E3779B97F4A7C15ULL;
+        hash ^= ((uint64_t)(uint32_t)key.startIndex << 32 | (uint32_t)key.endIndex) * 0xC2B2AE3D27D4EB4FULL;
+        hash ^= (uint64_t)key.algorithm * 0x165667B19E3779F9ULL;
+        return hash ^ (hash >> 29);
+    }
+};
+
+// Path stored as its moves, a Direction in two bits each and four to a byte
+struct PathCacheEntry
+{
+    PathCacheKey key;
+    SearchResult result;
+    bool hasPath;
+    std::vector<uint8_t> moves;
+};
+
+// Least recently used cache of solved queries, safe to share between threads. Every edit bumps the grid generation,
+// so entries of another generation can never be hit again and are all dropped once the generation changes.
+// A cache serves one grid, generations of different grids say nothing about each other
+struct PathCache
+{
+    size_t capacity;
+    uint64_t generation;
+    long long hits;
+    long long misses;
+
+    // Most recently used first
+    std::list<PathCacheEntry> entries;
+    std::unordered_map<PathCacheKey, std::list<PathCacheEntry>::iterator, PathCacheKeyHash> lookup;
+    std::mutex mutex;
+
+    PathCache(size_t capacity = PATH_CACHE_DEFAULT_CAPACITY) : capacity(capacity), generation(0), hits(0), misses(0) {}
+
+    // Looks a query up on the grid as it is now. Asking for the path misses on entries that were stored without one
+    bool Find(const Grid &grid, int startIndex, int endIndex, int algorithm, SearchResult &result, std::vector<int> *path = NULL);
+
+    // Stores a solved query, path holds every cell from start to end when given
+    void Insert(const Grid &grid, int startIndex, int endIndex, int algorithm, const SearchResult &result, const std::vector<int> *path = NULL);
+
+    void Clear();
+
+    // Drops every entry when the generation changed, called with the mutex held
+    void Advance(uint64_t generation);
+};
+
+// Packs a path of neighbouring cells into moves, returns false when two cells in a row are not neighbours
+bool PackPath(const Grid &grid, const std::vector<int> &path, std::vector<uint8_t> &moves);
+
+// Expands moveCount packed moves from start back into cells, start included
+void UnpackPath(const Grid &grid, int startIndex, const std::vector<uint8_t> &moves, int moveCount, std::vector<int> &path);
+
+#endif
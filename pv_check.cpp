@@ -0,0 +1,166 @@
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+#include "pv_parallel.h"
+
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+// Correctness checks of delta-stepping against Dijkstra, run by make check. Exits with an error when any check fails
+
+// Random weighted maps checked, each with CHECK_QUERY_COUNT random endpoint pairs
+#define CHECK_MAP_COUNT 40
+#define CHECK_QUERY_COUNT 8
+
+// Largest side of a random map, small enough that the whole check runs in a few seconds
+#define CHECK_MAX_SIDE 96
+
+// Worker counts tried, one runs the phases inline and the others split them over the pool
+static const int threadCounts[] = {1, 2, 4};
+static const int threadCountCount = 3;
+
+// Bucket widths tried, 0 is DELTA_STEPPING_DEFAULT_DELTA. Below, at and above the weighted cost
+static const int deltas[] = {0, 1, 3, WEIGHTED_COST, 64};
+static const int deltaCount = 5;
+
+static int failures = 0;
+static int checks = 0;
+
+static void Expect(bool condition, const char *what, int size, int startIndex, int endIndex)
+{
+    checks++;
+    if (!condition)
+    {
+        failures++;
+        printf("FAIL %s on %dx%d from %d to %d\n", what, size, size, startIndex, endIndex);
+    }
+}
+
+// Walls and weighted cells at the given chances per cell
+static void BuildRandomMap(Grid &grid, int size, double wallChance, double weightChance, std::mt19937 &engine)
+{
+    std::uniform_real_distribution<double> chance(0, 1);
+
+    grid.Resize(size, size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            double roll = chance(engine);
+            if (roll < wallChance)
+            {
+                grid.SetWall(grid.Index(x, y), true);
+            }
+            else if (roll < wallChance + weightChance)
+            {
+                grid.SetWeighted(grid.Index(x, y), true);
+            }
+        }
+    }
+}
+
+// Delta-stepping must find the same cost as Dijkstra for every pool size and delta
+static void CheckQuery(std::vector<ThreadPool *> &pools, const Grid &grid, int startIndex, int endIndex)
+{
+    SearchResult reference = RunSearch(searchDijkstra, grid, startIndex, endIndex);
+
+    for (ThreadPool *pool : pools)
+    {
+        for (int i = 0; i < deltaCount; i++)
+        {
+            SearchResult result = DeltaSteppingSearch(*pool, grid, startIndex, endIndex, deltas[i]);
+
+            Expect(result.found == reference.found, "found", grid.rows, startIndex, endIndex);
+            Expect(!reference.found || result.pathCost == reference.pathCost, "path cost", grid.rows, startIndex, endIndex);
+        }
+    }
+}
+
+static void CheckRandomMaps(std::vector<ThreadPool *> &pools, std::mt19937 &engine)
+{
+    std::uniform_int_distribution<int> side(2, CHECK_MAX_SIDE);
+    std::uniform_real_distribution<double> wallChance(0, 0.35);
+    std::uniform_real_distribution<double> weightChance(0, 0.5);
+
+    for (int map = 0; map < CHECK_MAP_COUNT; map++)
+    {
+        Grid grid = {0};
+        int size = side(engine);
+        BuildRandomMap(grid, size, wallChance(engine), weightChance(engine), engine);
+
+        std::uniform_int_distribution<int> cell(0, size - 1);
+        for (int query = 0; query < CHECK_QUERY_COUNT; query++)
+        {
+            int startIndex = grid.Index(cell(engine), cell(engine));
+            int endIndex = grid.Index(cell(engine), cell(engine));
+
+            if (!grid.IsWall(startIndex) && !grid.IsWall(endIndex))
+            {
+                CheckQuery(pools, grid, startIndex, endIndex);
+            }
+        }
+    }
+}
+
+// An end walled into its own corner is never found, by either search
+static void CheckUnreachable(std::vector<ThreadPool *> &pools, std::mt19937 &engine)
+{
+    int size = 48;
+    Grid grid = {0};
+    BuildRandomMap(grid, size, 0.1, 0.3, engine);
+
+    int startIndex = grid.Index(0, 0);
+    int endIndex = grid.Index(size - 1, size - 1);
+    grid.SetWall(startIndex, false);
+    grid.SetWall(endIndex, false);
+    grid.SetWall(grid.Index(size - 2, size - 1), true);
+    grid.SetWall(grid.Index(size - 1, size - 2), true);
+
+    SearchResult reference = RunSearch(searchDijkstra, grid, startIndex, endIndex);
+    Expect(!reference.found, "unreachable end stays unreachable for Dijkstra", size, startIndex, endIndex);
+    CheckQuery(pools, grid, startIndex, endIndex);
+}
+
+// A query from a cell to itself is found with an empty path
+static void CheckStartIsEnd(std::vector<ThreadPool *> &pools, std::mt19937 &engine)
+{
+    int size = 32;
+    Grid grid = {0};
+    BuildRandomMap(grid, size, 0.2, 0.3, engine);
+
+    int index = grid.Index(size / 2, size / 2);
+    grid.SetWall(index, false);
+    grid.SetWeighted(index, true);
+
+    for (ThreadPool *pool : pools)
+    {
+        for (int i = 0; i < deltaCount; i++)
+        {
+            SearchResult result = DeltaSteppingSearch(*pool, grid, index, index, deltas[i]);
+            Expect(result.found && result.pathCost == 0 && result.pathLength == 0, "start equal to end", size, index, index);
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 engine(1);
+    std::vector<ThreadPool *> pools;
+
+    for (int i = 0; i < threadCountCount; i++)
+    {
+        pools.push_back(new ThreadPool(threadCounts[i]));
+    }
+
+    CheckRandomMaps(pools, engine);
+    CheckUnreachable(pools, engine);
+    CheckStartIsEnd(pools, engine);
+
+    for (ThreadPool *pool : pools)
+    {
+        delete pool;
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
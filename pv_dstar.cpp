@@ -0,0 +1,357 @@
+#include "pv_dstar.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdlib.h>
+
+// Distance of a cell that cannot reach the end
+#define DSTAR_INFINITY INT_MAX
+
+// Lower bound on the cost of a move, keeps the Manhattan heuristic consistent
+#define DSTAR_MIN_COST DEFAULT_COST
+
+static int AddCost(int a, int b)
+{
+    return a == DSTAR_INFINITY || b == DSTAR_INFINITY ? DSTAR_INFINITY : a + b;
+}
+
+void DStarLite::CellChanged(int index)
+{
+    if (index >= 0 && index < size && !changedFlags[index])
+    {
+        changedFlags[index] = 1;
+        changed.push_back(index);
+    }
+}
+
+void DStarLite::Invalidate()
+{
+    endIndex = -1;
+}
+
+void DStarLite::Reset(int startIndex, int endIndex)
+{
+    size = grid->Size();
+    g.assign(size, DSTAR_INFINITY);
+    rhs.assign(size, DSTAR_INFINITY);
+    positions.assign(size, -1);
+    changedFlags.assign(size, 0);
+    heap.clear();
+    heapKeys.clear();
+    changed.clear();
+
+    this->startIndex = startIndex;
+    this->endIndex = endIndex;
+    lastStart = startIndex;
+    km = 0;
+
+    rhs[endIndex] = 0;
+    HeapPush(endIndex, CalculateKey(endIndex));
+}
+
+int DStarLite::Heuristic(int from, int to) const
+{
+    int stride = grid->stride;
+    return (abs(from % stride - to % stride) + abs(from / stride - to / stride)) * DSTAR_MIN_COST;
+}
+
+DStarKey DStarLite::CalculateKey(int index) const
+{
+    int distance = std::min(g[index], rhs[index]);
+
+    if (distance == DSTAR_INFINITY)
+    {
+        return {LLONG_MAX, DSTAR_INFINITY};
+    }
+    return {(long long)distance + Heuristic(startIndex, index) + km, distance};
+}
+
+// Moving onto a cell costs that cell, walls can be neither left nor entered
+int DStarLite::EdgeCost(int from, int to) const
+{
+    if (grid->IsWall(from) || grid->IsWall(to))
+    {
+        return DSTAR_INFINITY;
+    }
+    return grid->costs[to];
+}
+
+int DStarLite::BestNeighbourCost(int index) const
+{
+    int best = DSTAR_INFINITY;
+
+    for (int i = 0; i < 4; i++)
+    {
+        int neighbourIndex = index + grid->offsets[i];
+        best = std::min(best, AddCost(EdgeCost(index, neighbourIndex), g[neighbourIndex]));
+    }
+    return best;
+}
+
+void DStarLite::UpdateVertex(int index)
+{
+    bool queued = positions[index] != -1;
+
+    if (g[index] != rhs[index])
+    {
+        if (queued)
+        {
+            HeapUpdate(index, CalculateKey(index));
+        }
+        else
+        {
+            HeapPush(index, CalculateKey(index));
+        }
+    }
+    else if (queued)
+    {
+        HeapRemove(index);
+    }
+}
+
+long long DStarLite::ComputeShortestPath(std::vector<int> *expanded)
+{
+    long long expansions = 0;
+
+    while (!heap.empty() && (heapKeys[0] < CalculateKey(startIndex) || rhs[startIndex] > g[startIndex]))
+    {
+        int index = heap[0];
+        DStarKey oldKey = heapKeys[0];
+        DStarKey newKey = CalculateKey(index);
+
+        // Keys queued before km grew are too small, they are fixed when they reach the top
+        if (oldKey < newKey)
+        {
+            HeapUpdate(index, newKey);
+            continue;
+        }
+
+        expansions++;
+        if (expanded != NULL)
+        {
+            expanded->push_back(index);
+        }
+
+        if (g[index] > rhs[index])
+        {
+            // Overconsistent, the cell got cheaper and its neighbours may route through it
+            g[index] = rhs[index];
+            HeapRemove(index);
+
+            for (int i = 0; i < 4; i++)
+            {
+                int neighbourIndex = index + grid->offsets[i];
+
+                if (neighbourIndex != endIndex && !grid->IsWall(neighbourIndex))
+                {
+                    rhs[neighbourIndex] = std::min(rhs[neighbourIndex], AddCost(EdgeCost(neighbourIndex, index), g[index]));
+                    UpdateVertex(neighbourIndex);
+                }
+            }
+        }
+        else
+        {
+            // Underconsistent, the cell got more expensive and neighbours that routed through it look elsewhere
+            int oldG = g[index];
+            g[index] = DSTAR_INFINITY;
+
+            for (int i = 0; i <= 4; i++)
+            {
+                int neighbourIndex = i < 4 ? index + grid->offsets[i] : index;
+
+                if (neighbourIndex == endIndex || grid->IsBorder(neighbourIndex))
+                {
+                    continue;
+                }
+                if (neighbourIndex == index || rhs[neighbourIndex] == AddCost(EdgeCost(neighbourIndex, index), oldG))
+                {
+                    rhs[neighbourIndex] = grid->IsWall(neighbourIndex) ? DSTAR_INFINITY : BestNeighbourCost(neighbourIndex);
+                }
+                UpdateVertex(neighbourIndex);
+            }
+        }
+    }
+    return expansions;
+}
+
+SearchResult DStarLite::Plan(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path, std::vector<int> *expanded)
+{
+    SearchResult result = {false, 0, 0, 0};
+    this->grid = &grid;
+
+    if (path != NULL)
+    {
+        path->clear();
+    }
+
+    // The end is the root of the search, moving it invalidates every distance
+    if (grid.Size() != size || endIndex != this->endIndex)
+    {
+        Reset(startIndex, endIndex);
+    }
+    else if (startIndex != this->startIndex)
+    {
+        km += Heuristic(lastStart, startIndex);
+        lastStart = startIndex;
+        this->startIndex = startIndex;
+    }
+
+    // An edited cell changes its own edges and the edges of its neighbours into it
+    for (int index : changed)
+    {
+        changedFlags[index] = 0;
+
+        for (int i = 0; i <= 4; i++)
+        {
+            int neighbourIndex = i < 4 ? index + grid.offsets[i] : index;
+
+            if (neighbourIndex == endIndex || grid.IsBorder(neighbourIndex))
+            {
+                continue;
+            }
+
+            rhs[neighbourIndex] = grid.IsWall(neighbourIndex) ? DSTAR_INFINITY : BestNeighbourCost(neighbourIndex);
+            UpdateVertex(neighbourIndex);
+        }
+    }
+    changed.clear();
+
+    if (grid.IsWall(startIndex) || grid.IsWall(endIndex))
+    {
+        return result;
+    }
+
+    result.expansions = ComputeShortestPath(expanded);
+
+    if (rhs[startIndex] == DSTAR_INFINITY)
+    {
+        return result;
+    }
+
+    result.found = true;
+    result.pathCost = rhs[startIndex];
+
+    // Follow the cheapest neighbour toward the end
+    int index = startIndex;
+    if (path != NULL)
+    {
+        path->push_back(index);
+    }
+
+    while (index != endIndex)
+    {
+        int best = DSTAR_INFINITY;
+        int next = -1;
+
+        for (int i = 0; i < 4; i++)
+        {
+            int neighbourIndex = index + grid.offsets[i];
+            int cost = AddCost(EdgeCost(index, neighbourIndex), g[neighbourIndex]);
+
+            if (cost < best)
+            {
+                best = cost;
+                next = neighbourIndex;
+            }
+        }
+
+        index = next;
+        result.pathLength++;
+        if (path != NULL)
+        {
+            path->push_back(index);
+        }
+    }
+    return result;
+}
+
+void DStarLite::HeapSet(int slot, int index, DStarKey key)
+{
+    heap[slot] = index;
+    heapKeys[slot] = key;
+    positions[index] = slot;
+}
+
+void DStarLite::HeapSiftUp(int slot)
+{
+    int index = heap[slot];
+    DStarKey key = heapKeys[slot];
+
+    while (slot > 0)
+    {
+        int parent = (slot - 1) / 2;
+        if (!(key < heapKeys[parent]))
+        {
+            break;
+        }
+        HeapSet(slot, heap[parent], heapKeys[parent]);
+        slot = parent;
+    }
+    HeapSet(slot, index, key);
+}
+
+void DStarLite::HeapSiftDown(int slot)
+{
+    int count = heap.size();
+    int index = heap[slot];
+    DStarKey key = heapKeys[slot];
+
+    while (true)
+    {
+        int child = 2 * slot + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && heapKeys[child + 1] < heapKeys[child])
+        {
+            child++;
+        }
+        if (!(heapKeys[child] < key))
+        {
+            break;
+        }
+        HeapSet(slot, heap[child], heapKeys[child]);
+        slot = child;
+    }
+    HeapSet(slot, index, key);
+}
+
+void DStarLite::HeapPush(int index, DStarKey key)
+{
+    heap.push_back(index);
+    heapKeys.push_back(key);
+    positions[index] = heap.size() - 1;
+    HeapSiftUp(heap.size() - 1);
+}
+
+void DStarLite::HeapRemove(int index)
+{
+    int slot = positions[index];
+    int last = heap.size() - 1;
+
+    positions[index] = -1;
+    if (slot != last)
+    {
+        HeapSet(slot, heap[last], heapKeys[last]);
+    }
+    heap.pop_back();
+    heapKeys.pop_back();
+
+    // The last cell took over the slot and may belong above or below it
+    if (slot < (int)heap.size())
+    {
+        int moved = heap[slot];
+        HeapSiftUp(slot);
+        HeapSiftDown(positions[moved]);
+    }
+}
+
+void DStarLite::HeapUpdate(int index, DStarKey key)
+{
+    int slot = positions[index];
+
+    heapKeys[slot] = key;
+    HeapSiftUp(slot);
+    HeapSiftDown(positions[index]);
+}
@@ -0,0 +1,74 @@
+#ifndef PV_DSTAR_H
+#define PV_DSTAR_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+
+#include <vector>
+
+// Queue key of a cell, compared on primary first
+struct DStarKey
+{
+    long long primary;
+    int secondary;
+
+    bool operator<(const DStarKey &other) const
+    {
+        return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+    }
+};
+
+// D* Lite, an incremental search that keeps its distances between plans. It searches backward from the end, g is the
+// cost to the end a cell was last expanded with and rhs the cost its neighbours give it. Cells where the two differ sit in
+// the queue, so after an edit only the cells whose cost to the end changed are expanded again. A moved start is absorbed
+// by raising km instead of reordering the queue, a moved end or a resized grid starts over
+struct DStarLite
+{
+    const Grid *grid;
+    int size;
+    int startIndex;
+    int endIndex;
+    int lastStart;
+    long long km;
+
+    std::vector<int> g;
+    std::vector<int> rhs;
+
+    // Binary heap of cells with their keys, positions holds the heap slot of every cell or -1
+    std::vector<int> heap;
+    std::vector<DStarKey> heapKeys;
+    std::vector<int> positions;
+
+    // Cells edited since the last plan
+    std::vector<int> changed;
+    std::vector<uint8_t> changedFlags;
+
+    DStarLite() : grid(NULL), size(0), startIndex(-1), endIndex(-1), lastStart(-1), km(0) {}
+
+    // Records a cell whose wall or weight changed, it is repaired by the next plan
+    void CellChanged(int index);
+
+    // Drops every distance so the next plan starts over, for edits that touch the whole grid
+    void Invalidate();
+
+    // Plans from start to end reusing what the last plan found. Expansions count the cells taken off the queue by this
+    // plan only, path gets every cell from start to end and expanded every cell taken off the queue when given
+    SearchResult Plan(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path = NULL, std::vector<int> *expanded = NULL);
+
+    void Reset(int startIndex, int endIndex);
+    int Heuristic(int from, int to) const;
+    DStarKey CalculateKey(int index) const;
+    int EdgeCost(int from, int to) const;
+    int BestNeighbourCost(int index) const;
+    void UpdateVertex(int index);
+    long long ComputeShortestPath(std::vector<int> *expanded);
+
+    void HeapSet(int slot, int index, DStarKey key);
+    void HeapSiftUp(int slot);
+    void HeapSiftDown(int slot);
+    void HeapPush(int index, DStarKey key);
+    void HeapRemove(int index);
+    void HeapUpdate(int index, DStarKey key);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "pv_events.h"
+
+void EventRing::Reserve(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    buffer.assign(size, 0);
+    mask = size - 1;
+    Reset();
+}
+
+void EventRing::Reset()
+{
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cancelled.store(false, std::memory_order_relaxed);
+    waiting.store(false, std::memory_order_relaxed);
+}
+
+void EventRing::Cancel()
+{
+    // Set under the mutex so a producer between checking the flag and sleeping cannot miss the wake up
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+    notFull.notify_all();
+}
+
+bool EventRing::Push(GridEvent event)
+{
+    size_t currentTail = tail.load(std::memory_order_relaxed);
+
+    if (IsCancelled())
+    {
+        return false;
+    }
+
+    // Full, sleep until the renderer catches up. Waiting is raised before head is read again and Pop stores head
+    // before reading waiting, so either this sees the pop or Pop sees the waiter
+    if (currentTail - head.load(std::memory_order_acquire) > mask)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting.store(true, std::memory_order_seq_cst);
+        notFull.wait(lock, [&] { return IsCancelled() || currentTail - head.load(std::memory_order_seq_cst) <= mask; });
+        waiting.store(false, std::memory_order_relaxed);
+
+        if (IsCancelled())
+        {
+            return false;
+        }
+    }
+
+    buffer[currentTail & mask] = event;
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+}
+
+size_t EventRing::Pop(GridEvent *out, size_t maxEvents)
+{
+    size_t currentHead = head.load(std::memory_order_relaxed);
+    size_t available = tail.load(std::memory_order_acquire) - currentHead;
+    size_t count = available < maxEvents ? available : maxEvents;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = buffer[(currentHead + i) & mask];
+    }
+
+    head.store(currentHead + count, std::memory_order_seq_cst);
+
+    // Taking the mutex waits out a producer that has not gone to sleep yet, so the notify cannot be lost
+    if (count > 0 && waiting.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        notFull.notify_one();
+    }
+    return count;
+}
+
+void ApplyGridEvent(Grid &grid, GridEvent event)
+{
+    int index = GridEventIndex(event);
+
+    switch (GridEventKind(event))
+    {
+    case eventFrontier:
+        grid.states[index] = cellFrontier;
+        break;
+    case eventVisit:
+        grid.states[index] = cellVisited;
+        break;
+    case eventPath:
+        grid.states[index] = cellPath;
+        break;
+    case eventFrontierReverse:
+        grid.states[index] = cellFrontierReverse;
+        break;
+    case eventVisitReverse:
+        grid.states[index] = cellVisitedReverse;
+        break;
+    case eventCarve:
+        grid.SetWall(index, false);
+        break;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef PV_EVENTS_H
+#define PV_EVENTS_H
+
+#include "pv_grid.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Change made to a single cell by an algorithm
+enum GridEventType
+{
+    eventFrontier,
+    eventVisit,
+    eventPath,
+    eventCarve,
+    eventFrontierReverse,
+    eventVisitReverse
+};
+
+// Grid index in the upper 29 bits and the event type in the lower 3
+typedef uint32_t GridEvent;
+
+inline GridEvent MakeGridEvent(int index, GridEventType type)
+{
+    return ((uint32_t)index << 3) | type;
+}
+
+inline int GridEventIndex(GridEvent event)
+{
+    return event >> 3;
+}
+
+inline GridEventType GridEventKind(GridEvent event)
+{
+    return (GridEventType)(event & 7);
+}
+
+// Single producer single consumer ring buffer. The algorithm thread pushes and the render loop pops,
+// head and tail live on separate cache lines so the two threads do not share a line they both write.
+// A producer that finds the ring full sleeps until the renderer pops, slow speeds only drain a few events a frame
+struct EventRing
+{
+    std::vector<GridEvent> buffer;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<bool> cancelled;
+
+    // Only taken when the ring is full, waiting tells Pop whether it has anyone to wake
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::atomic<bool> waiting;
+
+    // Capacity is rounded up to a power of two
+    void Reserve(size_t capacity);
+    void Reset();
+    void Cancel();
+
+    bool IsCancelled() const
+    {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    bool IsEmpty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    // Sleeps while the ring is full, returns false if the ring was cancelled instead
+    bool Push(GridEvent event);
+
+    // Pops up to maxEvents events into out, returns how many were popped
+    size_t Pop(GridEvent *out, size_t maxEvents);
+};
+
+// Applies an event to the grid owned by the renderer
+void ApplyGridEvent(Grid &grid, GridEvent event);
+
+#endif
@@ -0,0 +1,96 @@
+#include "pv_flowfield.h"
+
+// Dijkstra buckets, one more than the largest cost a byte can hold
+#define FLOW_BUCKET_COUNT 256
+
+// Dial's algorithm from the end. Moving from a cell onto its neighbour costs the neighbour, so a cell next to one at
+// distance d is at most d plus the cost of that one, and its direction points back at it
+long long FlowField::Build(const Grid &grid, int endIndex)
+{
+    this->endIndex = endIndex;
+    distances.assign(grid.Size(), FLOW_UNREACHABLE);
+    directions.assign(grid.Size(), FLOW_NO_DIRECTION);
+
+    if (grid.IsWall(endIndex))
+    {
+        return 0;
+    }
+
+    std::vector<std::vector<int>> buckets(FLOW_BUCKET_COUNT);
+    long long reached = 0;
+    int pending = 1;
+
+    distances[endIndex] = 0;
+    buckets[0].push_back(endIndex);
+
+    for (int current = 0; pending > 0; current++)
+    {
+        std::vector<int> &bucket = buckets[current % FLOW_BUCKET_COUNT];
+
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            int index = bucket[i];
+            pending--;
+
+            // Stale entry, the cell was reached cheaper after it was pushed
+            if (distances[index] != current)
+            {
+                continue;
+            }
+            reached++;
+
+            int newDistance = current + grid.costs[index];
+
+            for (int j = 0; j < 4; j++)
+            {
+                int neighbourIndex = index + grid.offsets[j];
+
+                if (!grid.IsWall(neighbourIndex) && newDistance < distances[neighbourIndex])
+                {
+                    distances[neighbourIndex] = newDistance;
+                    // Directions are ordered so the opposite one is two further along
+                    directions[neighbourIndex] = (j + 2) & 3;
+                    buckets[newDistance % FLOW_BUCKET_COUNT].push_back(neighbourIndex);
+                    pending++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    return reached;
+}
+
+SearchResult FlowField::Follow(const Grid &grid, int startIndex, std::vector<int> *path) const
+{
+    SearchResult result = {false, 0, 0, 0};
+
+    if (path != NULL)
+    {
+        path->clear();
+    }
+    if (distances[startIndex] == FLOW_UNREACHABLE)
+    {
+        return result;
+    }
+
+    int index = startIndex;
+    if (path != NULL)
+    {
+        path->push_back(index);
+    }
+
+    while (index != endIndex)
+    {
+        index = Next(grid, index);
+        result.pathLength++;
+        result.pathCost += grid.costs[index];
+
+        if (path != NULL)
+        {
+            path->push_back(index);
+        }
+    }
+
+    result.found = true;
+    return result;
+}
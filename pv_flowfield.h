@@ -0,0 +1,44 @@
+#ifndef PV_FLOWFIELD_H
+#define PV_FLOWFIELD_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+
+#include <climits>
+#include <vector>
+
+// Integration field value of a cell that cannot reach the end
+#define FLOW_UNREACHABLE INT_MAX
+
+// Direction field value of the end, walls and cells that cannot reach the end
+#define FLOW_NO_DIRECTION 0xFF
+
+// Distances to one end cell from every cell and the move each cell makes toward it, computed by one Dijkstra run
+// backward from the end. Any number of agents heading to the end follow the directions at O(1) per step, where a
+// search per agent would repeat most of the work
+struct FlowField
+{
+    int endIndex;
+
+    // Integration field, the cost of the cheapest path from a cell to the end
+    std::vector<int> distances;
+
+    // Direction field, the Direction of the first move on that path
+    std::vector<uint8_t> directions;
+
+    FlowField() : endIndex(-1) {}
+
+    // Fills both fields for the end cell, returns the number of cells that can reach it
+    long long Build(const Grid &grid, int endIndex);
+
+    // Cell an agent on index moves to, the cell itself once at the end or stuck
+    int Next(const Grid &grid, int index) const
+    {
+        return directions[index] == FLOW_NO_DIRECTION ? index : index + grid.offsets[directions[index]];
+    }
+
+    // Walks the directions from the start to the end, path gets every cell when given
+    SearchResult Follow(const Grid &grid, int startIndex, std::vector<int> *path = NULL) const;
+};
+
+#endif
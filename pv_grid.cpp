@@ -0,0 +1,227 @@
+#include "pv_grid.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+
+bool Grid::Resize(int rows, int cols)
+{
+    if (!IsValidSize(rows, cols))
+    {
+        return false;
+    }
+
+    this->rows = rows;
+    this->cols = cols;
+    stride = cols + 2;
+
+    offsets[directionUp] = -stride;
+    offsets[directionLeft] = -1;
+    offsets[directionDown] = stride;
+    offsets[directionRight] = 1;
+
+    int size = Size();
+
+    // Only reallocate when the number of cells changes
+    if ((int)costs.size() != size)
+    {
+        walls.assign((size + 63) / 64, 0);
+        costs.assign(size, DEFAULT_COST);
+        states.assign(size, cellUnvisited);
+
+        walls.shrink_to_fit();
+        costs.shrink_to_fit();
+        states.shrink_to_fit();
+    }
+
+    Fill(false);
+    ResetStates();
+    return true;
+}
+
+void Grid::Fill(bool wall)
+{
+    generation++;
+    std::fill(walls.begin(), walls.end(), wall ? ~0ULL : 0ULL);
+    std::fill(costs.begin(), costs.end(), DEFAULT_COST);
+
+    // Sentinel border
+    int last = rows + 1;
+    for (int x = 0; x < stride; x++)
+    {
+        SetWall(x, true);
+        SetWall(last * stride + x, true);
+        costs[x] = BORDER_COST;
+        costs[last * stride + x] = BORDER_COST;
+    }
+    for (int y = 1; y < last; y++)
+    {
+        SetWall(y * stride, true);
+        SetWall(y * stride + stride - 1, true);
+        costs[y * stride] = BORDER_COST;
+        costs[y * stride + stride - 1] = BORDER_COST;
+    }
+}
+
+void Grid::ResetStates()
+{
+    std::fill(states.begin(), states.end(), cellUnvisited);
+}
+
+void Grid::SetWall(int index, bool wall)
+{
+    uint64_t bit = 1ULL << (index & 63);
+    generation++;
+
+    if (wall)
+    {
+        walls[index >> 6] |= bit;
+        costs[index] = DEFAULT_COST;
+    }
+    else
+    {
+        walls[index >> 6] &= ~bit;
+    }
+}
+
+void Grid::SetWeighted(int index, bool weighted)
+{
+    generation++;
+    costs[index] = weighted ? WEIGHTED_COST : DEFAULT_COST;
+}
+
+int Grid::MaxCost() const
+{
+    uint8_t maxCost = DEFAULT_COST;
+
+    for (uint8_t cost : costs)
+    {
+        maxCost = std::max(maxCost, cost);
+    }
+    return maxCost;
+}
+
+bool ReadGridFile(const char *fileName, Grid &grid, int &startIndex, int &endIndex)
+{
+    FILE *file = fopen(fileName, "r");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    int cols = 0;
+    int c;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        // Lines past the cell limit could never be loaded
+        if (line.size() > GRID_MAX_CELLS || lines.size() > GRID_MAX_CELLS)
+        {
+            fclose(file);
+            return false;
+        }
+
+        if (c == '\n')
+        {
+            lines.push_back(line);
+            cols = std::max(cols, (int)line.size());
+            line.clear();
+        }
+        else if (c != '\r')
+        {
+            line.push_back(c);
+        }
+    }
+    if (!line.empty())
+    {
+        lines.push_back(line);
+        cols = std::max(cols, (int)line.size());
+    }
+    fclose(file);
+
+    // Ignore trailing blank lines
+    while (!lines.empty() && lines.back().empty())
+    {
+        lines.pop_back();
+    }
+
+    if (lines.empty() || cols == 0 || !grid.Resize(lines.size(), cols))
+    {
+        return false;
+    }
+
+    startIndex = -1;
+    endIndex = -1;
+
+    for (int y = 0; y < grid.rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int index = grid.Index(x, y);
+            // Short lines are padded with walls
+            char cell = x < (int)lines[y].size() ? lines[y][x] : '#';
+
+            switch (cell)
+            {
+            case '#':
+                grid.SetWall(index, true);
+                break;
+            case 'w':
+                grid.SetWeighted(index, true);
+                break;
+            case 'S':
+                startIndex = index;
+                break;
+            case 'E':
+                endIndex = index;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool WriteGridFile(const char *fileName, const Grid &grid, int startIndex, int endIndex)
+{
+    FILE *file = fopen(fileName, "w");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    std::string line(grid.cols + 1, '\n');
+
+    for (int y = 0; y < grid.rows; y++)
+    {
+        for (int x = 0; x < grid.cols; x++)
+        {
+            int index = grid.Index(x, y);
+
+            if (index == startIndex)
+            {
+                line[x] = 'S';
+            }
+            else if (index == endIndex)
+            {
+                line[x] = 'E';
+            }
+            else if (grid.IsWall(index))
+            {
+                line[x] = '#';
+            }
+            else
+            {
+                line[x] = grid.IsWeighted(index) ? 'w' : '.';
+            }
+        }
+        fwrite(line.data(), 1, line.size(), file);
+    }
+
+    return fclose(file) == 0;
+}
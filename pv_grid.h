@@ -0,0 +1,108 @@
+#ifndef PV_GRID_H
+#define PV_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Cost of stepping onto a cell, the sentinel border is marked with a cost that no cell can be given
+#define BORDER_COST 0
+#define DEFAULT_COST 1
+#define WEIGHTED_COST 10
+
+// Largest grid in cells, the padded size of any grid up to this fits an int index
+#define GRID_MAX_CELLS 100000000
+
+// Search progress of a cell, mapped to a color by the renderer
+enum CellState
+{
+    cellUnvisited,
+    cellFrontier,
+    cellVisited,
+    cellPath,
+    cellFrontierReverse,
+    cellVisitedReverse
+};
+
+// Order of Grid::offsets
+enum Direction
+{
+    directionUp,
+    directionLeft,
+    directionDown,
+    directionRight
+};
+
+// Dense structure-of-arrays grid, walls are a bitset and costs and states a byte per cell.
+// The cells are surrounded by a one cell wall border so neighbours never need bounds checks,
+// every per cell array is indexed by the padded index returned from Index
+struct Grid
+{
+    int rows;
+    int cols;
+    int stride;
+    int offsets[4];
+
+    std::vector<uint64_t> walls;
+    std::vector<uint8_t> costs;
+    std::vector<uint8_t> states;
+
+    // Bumped by every change to a wall or cost, so caches can tell the grid they saw from an edited one
+    uint64_t generation = 0;
+
+    // Returns false and leaves the grid alone when either side is below one or the grid is over GRID_MAX_CELLS
+    bool Resize(int rows, int cols);
+    void Fill(bool wall);
+    void ResetStates();
+    void SetWall(int index, bool wall);
+    void SetWeighted(int index, bool weighted);
+    int MaxCost() const;
+
+    // Number of padded cells, including the border
+    int Size() const
+    {
+        return (int)((size_t)stride * (rows + 2));
+    }
+
+    static bool IsValidSize(int rows, int cols)
+    {
+        return rows >= 1 && cols >= 1 && (size_t)rows * cols <= GRID_MAX_CELLS;
+    }
+
+    int Index(int x, int y) const
+    {
+        return (y + 1) * stride + x + 1;
+    }
+
+    int X(int index) const
+    {
+        return index % stride - 1;
+    }
+
+    int Y(int index) const
+    {
+        return index / stride - 1;
+    }
+
+    bool IsWall(int index) const
+    {
+        return (walls[index >> 6] >> (index & 63)) & 1;
+    }
+
+    bool IsBorder(int index) const
+    {
+        return costs[index] == BORDER_COST;
+    }
+
+    bool IsWeighted(int index) const
+    {
+        return costs[index] > DEFAULT_COST;
+    }
+};
+
+// Text grid files have one line per row, '#' is a wall, '.' an empty cell, 'w' a weighted cell,
+// 'S' the start and 'E' the end. Start and end are -1 when the file does not contain them
+bool ReadGridFile(const char *fileName, Grid &grid, int &startIndex, int &endIndex);
+bool WriteGridFile(const char *fileName, const Grid &grid, int startIndex, int endIndex);
+
+#endif
@@ -1,57 +1,77 @@
-#ifndef PV_GUI_H
-#define PV_GUI_H
-
-#include "raylib.h"
-
-enum GuiButtonType
-{
-    buttonTypeText,
-    buttonTypeImage
-};
-
-enum GuiCenterStyle
-{
-    verticalSpaced,
-    verticalFill,
-    gridSpaced,
-    gridFill,
-    squareFill
-};
-
-struct GuiState
-{
-    int interactingWith;
-    int hovered;
-
-    bool locked;
-};
-
-struct Cell
-{
-    Rectangle bounds;
-    Color color;
-    bool weighted;
-    int id;
-
-    bool Draw();
-};
-
-struct Button
-{
-    Rectangle bounds;
-    const char *text;
-    GuiButtonType type;
-    Color color;
-    int id;
-
-    bool Draw();
-};
-
-// Centers the gui element with respect to the outer bounds based on the number of elements inside and the center style
-Rectangle CenterAndSizeGuiElement(Rectangle outerBounds, int numElements, int index, GuiCenterStyle centerStyle);
-
-void GuiLock();
-void GuiUnlock();
-bool GuiIsLocked();
-
+#ifndef PV_GUI_H
+#define PV_GUI_H
+
+#include "raylib.h"
+#include "pv_grid.h"
+
+enum GuiButtonType
+{
+    buttonTypeText,
+    buttonTypeImage
+};
+
+enum GuiCenterStyle
+{
+    verticalSpaced,
+    verticalFill,
+    gridSpaced,
+    gridFill,
+    squareFill
+};
+
+struct GuiState
+{
+    int interactingWith;
+    int hovered;
+
+    bool locked;
+};
+
+// Grid of square cells kept as its top left corner, cell size and dimensions, cell bounds are derived on demand
+struct GridLayout
+{
+    Vector2 origin;
+    float cellSize;
+    int rows;
+    int cols;
+
+    Rectangle Bounds() const;
+    Rectangle CellBounds(int x, int y) const;
+
+    // Cell under a point, false when the point is outside the grid
+    bool CellAt(Vector2 point, int &x, int &y) const;
+};
+
+struct Button
+{
+    Rectangle bounds;
+    const char *text;
+    GuiButtonType type;
+    Color color;
+    int id;
+
+    bool Draw();
+};
+
+// Horizontal slider holding a value between 0 and 1, stays usable while the gui is locked
+struct Slider
+{
+    Rectangle bounds;
+    const char *text;
+    float value;
+    int id;
+
+    bool Draw();
+};
+
+// Centers the gui element with respect to the outer bounds based on the number of elements inside and the center style
+Rectangle CenterAndSizeGuiElement(Rectangle outerBounds, int numElements, int index, GuiCenterStyle centerStyle);
+
+// Largest layout with square cells for a rows x cols grid, centered in the outer bounds
+GridLayout FitGridLayout(Rectangle outerBounds, int rows, int cols);
+
+void GuiLock();
+void GuiUnlock();
+bool GuiIsLocked();
+
 #endif
\ No newline at end of file
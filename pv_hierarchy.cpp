@@ -0,0 +1,724 @@
+#include "pv_hierarchy.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <stdlib.h>
+
+// Lower bound on the cost of a move, keeps the Manhattan heuristic admissible
+#define HPA_MIN_COST DEFAULT_COST
+
+// Cluster search buckets, one more than the largest cost a byte can hold
+#define HPA_BUCKET_COUNT 256
+
+void HpaScratch::Reserve()
+{
+    int localCount = HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE;
+
+    localCosts.resize(localCount);
+    localLengths.resize(localCount);
+    localParents.resize(localCount);
+    localBuckets.resize(HPA_BUCKET_COUNT);
+}
+
+void HpaQueryScratch::Reserve(int nodeCount)
+{
+    // Stamps left by a query on an older graph are all below the next stamp, so only a new size needs clearing
+    if ((int)stamps.size() != nodeCount)
+    {
+        stamp = 0;
+        stamps.assign(nodeCount, 0);
+        nodeCosts.resize(nodeCount);
+        nodeLengths.resize(nodeCount);
+        parents.resize(nodeCount);
+    }
+    if (exitCosts.empty())
+    {
+        exitCosts.resize(HPA_CLUSTER_NODES);
+        exitLengths.resize(HPA_CLUSTER_NODES);
+        cluster.Reserve();
+    }
+}
+
+void HierarchicalGraph::ForEachCluster(const std::vector<int> &list, ThreadPool *pool, const std::function<void(int cluster, HpaScratch &buffers)> &body)
+{
+    int workers = pool != NULL ? pool->Size() : 1;
+
+    if ((int)scratch.size() < workers)
+    {
+        scratch.resize(workers);
+        for (HpaScratch &buffers : scratch)
+        {
+            buffers.Reserve();
+        }
+    }
+
+    if (pool == NULL)
+    {
+        for (int cluster : list)
+        {
+            body(cluster, scratch[0]);
+        }
+        return;
+    }
+
+    pool->ParallelFor(list.size(), HPA_BUILD_GRAIN, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++)
+        {
+            body(list[i], scratch[worker]);
+        }
+    });
+}
+
+void HierarchicalGraph::Build(const Grid &grid, ThreadPool *pool)
+{
+    rows = grid.rows;
+    cols = grid.cols;
+    clusterRows = (rows + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+    clusterCols = (cols + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+
+    int clusterCount = clusterRows * clusterCols;
+    clusters.assign(clusterCount, HpaCluster());
+
+    std::vector<int> all(clusterCount);
+    std::iota(all.begin(), all.end(), 0);
+
+    // Every cluster needs its entrances before any of them can be linked to a neighbour. After that a cluster only
+    // writes its own links and costs, so each pass is split over the pool
+    ForEachCluster(all, pool, [&](int cluster, HpaScratch &) {
+        for (int index : ClusterNodes(grid, cluster))
+        {
+            clusters[cluster].nodes.push_back({index, {-1, -1, -1, -1}});
+        }
+    });
+    ForEachCluster(all, pool, [&](int cluster, HpaScratch &buffers) {
+        LinkCluster(grid, cluster);
+        ComputeCosts(grid, cluster, buffers);
+    });
+}
+
+void HierarchicalGraph::MarkDirty(int x, int y)
+{
+    if (x >= 0 && y >= 0 && x < cols && y < rows)
+    {
+        clusters[(y / HPA_CLUSTER_SIZE) * clusterCols + x / HPA_CLUSTER_SIZE].dirty = true;
+    }
+}
+
+void HierarchicalGraph::MarkAllDirty()
+{
+    for (HpaCluster &cluster : clusters)
+    {
+        cluster.dirty = true;
+    }
+}
+
+int HierarchicalGraph::Update(const Grid &grid, ThreadPool *pool)
+{
+    if (grid.rows != rows || grid.cols != cols)
+    {
+        Build(grid, pool);
+        return clusters.size();
+    }
+
+    // Entrances sit on both sides of a border, so a changed cluster can move the entrances of its neighbours
+    int clusterCount = clusters.size();
+    std::vector<uint8_t> candidates(clusterCount, 0);
+
+    for (int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        if (!clusters[cluster].dirty)
+        {
+            continue;
+        }
+
+        int cx = cluster % clusterCols;
+        int cy = cluster / clusterCols;
+
+        candidates[cluster] = 1;
+        candidates[cluster - (cy > 0 ? clusterCols : 0)] = 1;
+        candidates[cluster - (cx > 0 ? 1 : 0)] = 1;
+        candidates[cluster + (cy < clusterRows - 1 ? clusterCols : 0)] = 1;
+        candidates[cluster + (cx < clusterCols - 1 ? 1 : 0)] = 1;
+    }
+
+    // Clean neighbours are only rebuilt when their entrances moved
+    std::vector<int> rebuilt;
+
+    for (int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        if (!candidates[cluster])
+        {
+            continue;
+        }
+
+        std::vector<int> cells = ClusterNodes(grid, cluster);
+        std::vector<HpaNode> &nodes = clusters[cluster].nodes;
+        bool moved = cells.size() != nodes.size();
+
+        for (size_t i = 0; !moved && i < cells.size(); i++)
+        {
+            moved = cells[i] != nodes[i].index;
+        }
+
+        if (!moved && !clusters[cluster].dirty)
+        {
+            continue;
+        }
+
+        nodes.clear();
+        for (int index : cells)
+        {
+            nodes.push_back({index, {-1, -1, -1, -1}});
+        }
+        rebuilt.push_back(cluster);
+    }
+
+    // Links into a rebuilt cluster point at its old slots, so its neighbours are linked again as well
+    std::fill(candidates.begin(), candidates.end(), 0);
+
+    for (int cluster : rebuilt)
+    {
+        int cx = cluster % clusterCols;
+        int cy = cluster / clusterCols;
+
+        candidates[cluster] = 1;
+        candidates[cluster - (cy > 0 ? clusterCols : 0)] = 1;
+        candidates[cluster - (cx > 0 ? 1 : 0)] = 1;
+        candidates[cluster + (cy < clusterRows - 1 ? clusterCols : 0)] = 1;
+        candidates[cluster + (cx < clusterCols - 1 ? 1 : 0)] = 1;
+    }
+    for (int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        if (candidates[cluster])
+        {
+            LinkCluster(grid, cluster);
+        }
+    }
+
+    ForEachCluster(rebuilt, pool, [&](int cluster, HpaScratch &buffers) {
+        ComputeCosts(grid, cluster, buffers);
+    });
+    return rebuilt.size();
+}
+
+// Entrances of a cluster in a fixed order. Every border is walked cell by cell, a run of cells that are open on both
+// sides gets an entrance in its middle or, when it is long, one at each end. The neighbour walks the same cells from its
+// side, so the entrances of a border always come in pairs facing each other
+std::vector<int> HierarchicalGraph::ClusterNodes(const Grid &grid, int cluster) const
+{
+    std::vector<int> cells;
+    int cx = cluster % clusterCols;
+    int cy = cluster / clusterCols;
+    int x0 = cx * HPA_CLUSTER_SIZE;
+    int y0 = cy * HPA_CLUSTER_SIZE;
+    int x1 = std::min(x0 + HPA_CLUSTER_SIZE, cols) - 1;
+    int y1 = std::min(y0 + HPA_CLUSTER_SIZE, rows) - 1;
+
+    bool hasNeighbour[4] = {cy > 0, cx > 0, cy < clusterRows - 1, cx < clusterCols - 1};
+    int firstCell[4] = {grid.Index(x0, y0), grid.Index(x0, y0), grid.Index(x0, y1), grid.Index(x1, y0)};
+
+    auto addCell = [&](int index) {
+        if (std::find(cells.begin(), cells.end(), index) == cells.end())
+        {
+            cells.push_back(index);
+        }
+    };
+
+    for (int direction = 0; direction < 4; direction++)
+    {
+        if (!hasNeighbour[direction])
+        {
+            continue;
+        }
+
+        // Up and down borders run along a row, left and right ones down a column
+        bool alongRow = direction == directionUp || direction == directionDown;
+        int length = alongRow ? x1 - x0 + 1 : y1 - y0 + 1;
+        int step = alongRow ? 1 : grid.stride;
+        int first = firstCell[direction];
+        int across = grid.offsets[direction];
+        int run = 0;
+
+        for (int i = 0; i <= length; i++)
+        {
+            int index = first + i * step;
+
+            if (i < length && !grid.IsWall(index) && !grid.IsWall(index + across))
+            {
+                run++;
+                continue;
+            }
+            if (run == 0)
+            {
+                continue;
+            }
+
+            int runStart = i - run;
+            if (run >= HPA_ENTRANCE_SPLIT)
+            {
+                addCell(first + runStart * step);
+                addCell(first + (i - 1) * step);
+            }
+            else
+            {
+                addCell(first + (runStart + (run - 1) / 2) * step);
+            }
+            run = 0;
+        }
+    }
+    return cells;
+}
+
+int HierarchicalGraph::FindNode(int cluster, int index) const
+{
+    const std::vector<HpaNode> &nodes = clusters[cluster].nodes;
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].index == index)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Links every entrance to the entrances next to it in neighbouring clusters
+void HierarchicalGraph::LinkCluster(const Grid &grid, int cluster)
+{
+    for (HpaNode &node : clusters[cluster].nodes)
+    {
+        for (int direction = 0; direction < 4; direction++)
+        {
+            int neighbourIndex = node.index + grid.offsets[direction];
+            node.links[direction] = -1;
+
+            // The wall check also keeps the border out, its coordinates are outside of every cluster
+            if (grid.IsWall(neighbourIndex))
+            {
+                continue;
+            }
+
+            int neighbourCluster = ClusterOf(grid, neighbourIndex);
+            if (neighbourCluster == cluster)
+            {
+                continue;
+            }
+
+            int slot = FindNode(neighbourCluster, neighbourIndex);
+            if (slot != -1)
+            {
+                node.links[direction] = neighbourCluster * HPA_CLUSTER_NODES + slot;
+            }
+        }
+    }
+}
+
+void HierarchicalGraph::ComputeCosts(const Grid &grid, int cluster, HpaScratch &buffers)
+{
+    HpaCluster &current = clusters[cluster];
+    int count = current.nodes.size();
+    std::vector<int> &pairCosts = buffers.pairCosts;
+    std::vector<int> &pairLengths = buffers.pairLengths;
+
+    pairCosts.resize(count * count);
+    pairLengths.resize(count * count);
+
+    for (int i = 0; i < count; i++)
+    {
+        SearchCluster(grid, cluster, current.nodes[i].index, false, buffers);
+
+        for (int j = 0; j < count; j++)
+        {
+            int local = LocalIndex(grid, cluster, current.nodes[j].index);
+            pairCosts[i * count + j] = buffers.localCosts[local];
+            pairLengths[i * count + j] = buffers.localLengths[local];
+        }
+    }
+
+    // Open clusters have paths between most entrances passing other entrances on the way, dropping those edges leaves
+    // far fewer to relax for every expanded node
+    current.edges.clear();
+    current.firstEdge.resize(count + 1);
+
+    for (int i = 0; i < count; i++)
+    {
+        current.firstEdge[i] = current.edges.size();
+
+        for (int j = 0; j < count; j++)
+        {
+            int cost = pairCosts[i * count + j];
+            bool redundant = i == j || cost == INT_MAX;
+
+            for (int k = 0; k < count && !redundant; k++)
+            {
+                int first = pairCosts[i * count + k];
+                int second = pairCosts[k * count + j];
+
+                redundant = k != i && k != j && first != INT_MAX && second != INT_MAX && first + second == cost;
+            }
+
+            if (!redundant)
+            {
+                current.edges.push_back({j, cost, pairLengths[i * count + j]});
+            }
+        }
+    }
+    current.firstEdge[count] = current.edges.size();
+    current.dirty = false;
+}
+
+int HierarchicalGraph::LocalIndex(const Grid &grid, int cluster, int index) const
+{
+    int x0 = (cluster % clusterCols) * HPA_CLUSTER_SIZE;
+    int y0 = (cluster / clusterCols) * HPA_CLUSTER_SIZE;
+
+    return (grid.Y(index) - y0) * HPA_CLUSTER_SIZE + grid.X(index) - x0;
+}
+
+// Dial's algorithm, every cost fits in a byte so a ring of HPA_BUCKET_COUNT buckets holds all pending distances
+int HierarchicalGraph::SearchCluster(const Grid &grid, int cluster, int index, bool reverse, HpaScratch &buffers) const
+{
+    int x0 = (cluster % clusterCols) * HPA_CLUSTER_SIZE;
+    int y0 = (cluster / clusterCols) * HPA_CLUSTER_SIZE;
+    int width = std::min(x0 + HPA_CLUSTER_SIZE, cols) - x0;
+    int height = std::min(y0 + HPA_CLUSTER_SIZE, rows) - y0;
+    int corner = grid.Index(x0, y0);
+    int localOffsets[4] = {-HPA_CLUSTER_SIZE, -1, HPA_CLUSTER_SIZE, 1};
+    int expansions = 0;
+    std::vector<int> &localCosts = buffers.localCosts;
+    std::vector<int> &localLengths = buffers.localLengths;
+    std::vector<int> &localParents = buffers.localParents;
+    std::vector<std::vector<int>> &localBuckets = buffers.localBuckets;
+
+    std::fill(localCosts.begin(), localCosts.end(), INT_MAX);
+
+    int source = LocalIndex(grid, cluster, index);
+    localCosts[source] = 0;
+    localLengths[source] = 0;
+    localParents[source] = -1;
+    localBuckets[0].push_back(source);
+
+    for (int distance = 0, pending = 1; pending > 0; distance++)
+    {
+        // Moves cost at least one, so nothing is added to the bucket being drained
+        std::vector<int> &bucket = localBuckets[distance % HPA_BUCKET_COUNT];
+
+        for (int local : bucket)
+        {
+            pending--;
+            if (localCosts[local] != distance)
+            {
+                continue;
+            }
+            expansions++;
+
+            int x = local % HPA_CLUSTER_SIZE;
+            int y = local / HPA_CLUSTER_SIZE;
+            int currentIndex = corner + y * grid.stride + x;
+            bool inside[4] = {y > 0, x > 0, y < height - 1, x < width - 1};
+
+            for (int direction = 0; direction < 4; direction++)
+            {
+                int neighbourIndex = currentIndex + grid.offsets[direction];
+
+                if (!inside[direction] || grid.IsWall(neighbourIndex))
+                {
+                    continue;
+                }
+
+                // Searching toward the source pays for the cell being left, which is the cell entered going forward
+                int cost = distance + grid.costs[reverse ? currentIndex : neighbourIndex];
+                int neighbour = local + localOffsets[direction];
+
+                if (cost < localCosts[neighbour])
+                {
+                    localCosts[neighbour] = cost;
+                    localLengths[neighbour] = localLengths[local] + 1;
+                    localParents[neighbour] = local;
+                    localBuckets[cost % HPA_BUCKET_COUNT].push_back(neighbour);
+                    pending++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    return expansions;
+}
+
+void HierarchicalGraph::TraceCluster(const Grid &grid, int cluster, int index, bool reverse, const HpaScratch &buffers,
+                                     std::vector<int> &path) const
+{
+    const std::vector<int> &localParents = buffers.localParents;
+    int x0 = (cluster % clusterCols) * HPA_CLUSTER_SIZE;
+    int y0 = (cluster / clusterCols) * HPA_CLUSTER_SIZE;
+    int local = LocalIndex(grid, cluster, index);
+    size_t first = path.size();
+
+    // Reverse parents already lead from index toward the source, forward ones are walked back and flipped
+    if (reverse)
+    {
+        local = localParents[local];
+    }
+    while (local != -1 && (reverse || localParents[local] != -1))
+    {
+        path.push_back(grid.Index(x0 + local % HPA_CLUSTER_SIZE, y0 + local / HPA_CLUSTER_SIZE));
+        local = localParents[local];
+    }
+    if (!reverse)
+    {
+        std::reverse(path.begin() + first, path.end());
+    }
+}
+
+void HpaQueryScratch::Relax(int id, int cost, int length, int parent, int heuristic)
+{
+    if (stamps[id] == stamp && cost >= nodeCosts[id])
+    {
+        return;
+    }
+
+    stamps[id] = stamp;
+    nodeCosts[id] = cost;
+    nodeLengths[id] = length;
+    parents[id] = parent;
+
+    // The heuristic is consistent, so priorities never drop below the bucket being drained
+    int bucket = cost + heuristic - openBase;
+    if (bucket >= (int)open.size())
+    {
+        open.resize(bucket + 1);
+    }
+    open[bucket].push_back({cost, id});
+    openCurrent = std::min(openCurrent, bucket);
+}
+
+SearchResult HierarchicalGraph::Search(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path)
+{
+    return Search(grid, startIndex, endIndex, path, searchScratch);
+}
+
+SearchResult HierarchicalGraph::Search(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path, HpaQueryScratch &query) const
+{
+    SearchResult result = {false, 0, 0, 0};
+
+    if (path != NULL)
+    {
+        path->clear();
+    }
+    if (grid.IsWall(startIndex) || grid.IsWall(endIndex))
+    {
+        return result;
+    }
+    if (startIndex == endIndex)
+    {
+        result.found = true;
+        if (path != NULL)
+        {
+            path->push_back(startIndex);
+        }
+        return result;
+    }
+
+    int goal = clusters.size() * HPA_CLUSTER_NODES;
+    query.Reserve(goal + 1);
+
+    // Stamps wrap after four billion queries
+    if (++query.stamp == 0)
+    {
+        std::fill(query.stamps.begin(), query.stamps.end(), 0);
+        query.stamp = 1;
+    }
+
+    int startCluster = ClusterOf(grid, startIndex);
+    int endCluster = ClusterOf(grid, endIndex);
+    int endX = grid.X(endIndex);
+    int endY = grid.Y(endIndex);
+    HpaScratch &buffers = query.cluster;
+    const std::vector<int> &localCosts = buffers.localCosts;
+    const std::vector<int> &localLengths = buffers.localLengths;
+
+    auto heuristic = [&](int index) {
+        return (abs(grid.X(index) - endX) + abs(grid.Y(index) - endY)) * HPA_MIN_COST;
+    };
+
+    // No priority can be below the heuristic of the start
+    query.openBase = heuristic(startIndex);
+    query.openCurrent = 0;
+
+    // Join the start to the entrances of its cluster, and straight to the end when both share a cluster
+    result.expansions += SearchCluster(grid, startCluster, startIndex, false, buffers);
+
+    const std::vector<HpaNode> &startNodes = clusters[startCluster].nodes;
+    for (size_t i = 0; i < startNodes.size(); i++)
+    {
+        int local = LocalIndex(grid, startCluster, startNodes[i].index);
+        if (localCosts[local] != INT_MAX)
+        {
+            query.Relax(startCluster * HPA_CLUSTER_NODES + i, localCosts[local], localLengths[local], -1, heuristic(startNodes[i].index));
+        }
+    }
+    if (startCluster == endCluster)
+    {
+        int local = LocalIndex(grid, endCluster, endIndex);
+        if (localCosts[local] != INT_MAX)
+        {
+            query.Relax(goal, localCosts[local], localLengths[local], -1, 0);
+        }
+    }
+
+    // Join the entrances of the end cluster to the end
+    result.expansions += SearchCluster(grid, endCluster, endIndex, true, buffers);
+
+    const std::vector<HpaNode> &endNodes = clusters[endCluster].nodes;
+    for (size_t i = 0; i < endNodes.size(); i++)
+    {
+        int local = LocalIndex(grid, endCluster, endNodes[i].index);
+        query.exitCosts[i] = localCosts[local];
+        query.exitLengths[i] = localLengths[local];
+    }
+
+    std::vector<std::vector<HpaEntry>> &open = query.open;
+    int &openCurrent = query.openCurrent;
+
+    while (true)
+    {
+        while (openCurrent < (int)open.size() && open[openCurrent].empty())
+        {
+            openCurrent++;
+        }
+        if (openCurrent == (int)open.size())
+        {
+            break;
+        }
+
+        // Last in first out within a bucket favours the larger cost, the entry closer to the end
+        HpaEntry entry = open[openCurrent].back();
+        open[openCurrent].pop_back();
+
+        if (entry.cost != query.nodeCosts[entry.id])
+        {
+            continue;
+        }
+        if (entry.id == goal)
+        {
+            result.found = true;
+            break;
+        }
+        result.expansions++;
+
+        int cluster = entry.id / HPA_CLUSTER_NODES;
+        int slot = entry.id % HPA_CLUSTER_NODES;
+        const HpaCluster &current = clusters[cluster];
+        const HpaNode &node = current.nodes[slot];
+        int length = query.nodeLengths[entry.id];
+
+        for (int i = current.firstEdge[slot]; i < current.firstEdge[slot + 1]; i++)
+        {
+            const HpaEdge &edge = current.edges[i];
+            query.Relax(cluster * HPA_CLUSTER_NODES + edge.slot, entry.cost + edge.cost, length + edge.length, entry.id,
+                        heuristic(current.nodes[edge.slot].index));
+        }
+
+        for (int direction = 0; direction < 4; direction++)
+        {
+            int link = node.links[direction];
+            if (link != -1)
+            {
+                int linkIndex = node.index + grid.offsets[direction];
+                query.Relax(link, entry.cost + grid.costs[linkIndex], length + 1, entry.id, heuristic(linkIndex));
+            }
+        }
+
+        if (cluster == endCluster && query.exitCosts[slot] != INT_MAX)
+        {
+            query.Relax(goal, entry.cost + query.exitCosts[slot], length + query.exitLengths[slot], entry.id, 0);
+        }
+    }
+
+    for (std::vector<HpaEntry> &bucket : open)
+    {
+        bucket.clear();
+    }
+
+    if (!result.found)
+    {
+        return result;
+    }
+
+    result.pathCost = query.nodeCosts[goal];
+    result.pathLength = query.nodeLengths[goal];
+
+    if (path == NULL)
+    {
+        return result;
+    }
+
+    // Refine the abstract path by searching each cluster it crosses again
+    std::vector<int> chain;
+    for (int id = query.parents[goal]; id != -1; id = query.parents[id])
+    {
+        chain.push_back(id);
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    path->push_back(startIndex);
+    SearchCluster(grid, startCluster, startIndex, false, buffers);
+
+    if (chain.empty())
+    {
+        TraceCluster(grid, startCluster, endIndex, false, buffers, *path);
+        return result;
+    }
+
+    TraceCluster(grid, startCluster, clusters[chain[0] / HPA_CLUSTER_NODES].nodes[chain[0] % HPA_CLUSTER_NODES].index, false, buffers,
+                 *path);
+
+    for (size_t i = 1; i < chain.size(); i++)
+    {
+        int fromCluster = chain[i - 1] / HPA_CLUSTER_NODES;
+        int toCluster = chain[i] / HPA_CLUSTER_NODES;
+        int fromIndex = clusters[fromCluster].nodes[chain[i - 1] % HPA_CLUSTER_NODES].index;
+        int toIndex = clusters[toCluster].nodes[chain[i] % HPA_CLUSTER_NODES].index;
+
+        // Links cross a border in a single move
+        if (fromCluster != toCluster)
+        {
+            path->push_back(toIndex);
+            continue;
+        }
+
+        SearchCluster(grid, fromCluster, fromIndex, false, buffers);
+        TraceCluster(grid, fromCluster, toIndex, false, buffers, *path);
+    }
+
+    SearchCluster(grid, endCluster, endIndex, true, buffers);
+    TraceCluster(grid, endCluster, path->back(), true, buffers, *path);
+    return result;
+}
+
+std::vector<SearchResult> SolveBatch(ThreadPool &pool, const HierarchicalGraph &graph, const Grid &grid, const std::vector<BatchQuery> &queries,
+                                     PathCache *cache)
+{
+    std::vector<SearchResult> results(queries.size());
+    std::vector<HpaQueryScratch> scratch(pool.Size());
+    std::vector<std::vector<int>> paths(pool.Size());
+
+    pool.ParallelForStealing(queries.size(), [&](int index, int worker) {
+        const BatchQuery &query = queries[index];
+
+        if (cache != NULL && cache->Find(grid, query.startIndex, query.endIndex, HPA_CACHE_ALGORITHM, results[index]))
+        {
+            return;
+        }
+
+        results[index] = graph.Search(grid, query.startIndex, query.endIndex, cache != NULL ? &paths[worker] : NULL, scratch[worker]);
+
+        if (cache != NULL)
+        {
+            cache->Insert(grid, query.startIndex, query.endIndex, HPA_CACHE_ALGORITHM, results[index], &paths[worker]);
+        }
+    });
+    return results;
+}
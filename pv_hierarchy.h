@@ -0,0 +1,175 @@
+#ifndef PV_HIERARCHY_H
+#define PV_HIERARCHY_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+#include "pv_parallel.h"
+
+#include <vector>
+
+// Side of the square clusters the grid is cut into
+#define HPA_CLUSTER_SIZE 32
+
+// Open runs along a cluster border at least this long get an entrance at both ends instead of one in the middle
+#define HPA_ENTRANCE_SPLIT 6
+
+// Most entrance nodes a cluster can hold, a border of HPA_CLUSTER_SIZE cells has at most half of them as entrances
+#define HPA_CLUSTER_NODES (2 * HPA_CLUSTER_SIZE)
+
+// Clusters handed to a pool worker at a time when building in parallel
+#define HPA_BUILD_GRAIN 16
+
+// Path cache id of HPA* queries, kept apart from every SearchType
+#define HPA_CACHE_ALGORITHM 256
+
+// Entrance cell of a cluster, a node of the abstract graph
+struct HpaNode
+{
+    int index;
+
+    // Node across the cluster border in each direction, -1 when there is none
+    int links[4];
+};
+
+// Open list entry, stale once the node has been reached at a lower cost
+struct HpaEntry
+{
+    int cost;
+    int id;
+};
+
+// Cheapest path between two entrances of a cluster that stays inside it
+struct HpaEdge
+{
+    int slot;
+    int cost;
+    int length;
+};
+
+// Search scratch for a single cluster, indexed by the cell position inside the cluster. Every thread computing
+// clusters needs its own
+struct HpaScratch
+{
+    std::vector<int> localCosts;
+    std::vector<int> localLengths;
+    std::vector<int> localParents;
+    std::vector<std::vector<int>> localBuckets;
+
+    // Entrance to entrance costs of the cluster being computed, row major by the node moved from
+    std::vector<int> pairCosts;
+    std::vector<int> pairLengths;
+
+    void Reserve();
+};
+
+// Abstract search state of one query, stamped per query so it never needs clearing. The extra last node is the end
+// cell. Queries only read the graph, so threads running them at once each need their own
+struct HpaQueryScratch
+{
+    unsigned int stamp;
+    std::vector<unsigned int> stamps;
+    std::vector<int> nodeCosts;
+    std::vector<int> nodeLengths;
+    std::vector<int> parents;
+
+    // Open list bucketed by priority, bucket i holds priority openBase + i
+    std::vector<std::vector<HpaEntry>> open;
+    int openBase;
+    int openCurrent;
+
+    // Cost and moves from each entrance of the end cluster to the end cell
+    std::vector<int> exitCosts;
+    std::vector<int> exitLengths;
+
+    // Searches joining the start and end to their clusters and refining the path
+    HpaScratch cluster;
+
+    HpaQueryScratch() : stamp(0), openBase(0), openCurrent(0) {}
+
+    // Sizes the node arrays for a graph of nodeCount nodes, keeping them when they already fit
+    void Reserve(int nodeCount);
+
+    void Relax(int id, int cost, int length, int parent, int heuristic);
+};
+
+struct HpaCluster
+{
+    bool dirty;
+    std::vector<HpaNode> nodes;
+
+    // Edges of node i are edges[firstEdge[i]] up to edges[firstEdge[i + 1]]. An edge is left out when going through
+    // another entrance of the cluster costs the same, which keeps every abstract distance
+    std::vector<HpaEdge> edges;
+    std::vector<int> firstEdge;
+};
+
+// HPA* over a cached abstract graph. The grid is cut into clusters, every open run along a cluster border becomes one or
+// two entrances and the entrance to entrance costs inside each cluster are precomputed. A query only searches the
+// clusters holding the start and end cell to join them to the graph, the rest is A* over entrances. Paths are close to
+// optimal but not always optimal, they can only cross cluster borders at entrances.
+//
+// Node ids are cluster * HPA_CLUSTER_NODES + slot. Edits mark clusters dirty and Update rebuilds those clusters,
+// and the neighbours whose entrances changed with them. Building runs one search per entrance of every cluster and
+// is spread over a thread pool when given one
+struct HierarchicalGraph
+{
+    int rows;
+    int cols;
+    int clusterRows;
+    int clusterCols;
+    std::vector<HpaCluster> clusters;
+
+    // Query scratch of the Search overload without one
+    HpaQueryScratch searchScratch;
+
+    // Cluster scratch of each pool worker while building
+    std::vector<HpaScratch> scratch;
+
+    HierarchicalGraph() : rows(0), cols(0), clusterRows(0), clusterCols(0) {}
+
+    // Builds every cluster for the grid
+    void Build(const Grid &grid, ThreadPool *pool = NULL);
+
+    // Flags the cluster holding cell x, y as changed
+    void MarkDirty(int x, int y);
+    void MarkAllDirty();
+
+    // Rebuilds dirty clusters and neighbours whose entrances moved, a grid of another size is built from scratch.
+    // Returns the number of clusters whose costs were recomputed
+    int Update(const Grid &grid, ThreadPool *pool = NULL);
+
+    // Answers from the abstract graph, path gets every cell from start to end when given. Expansions count the
+    // cells searched to join the start and end plus the abstract nodes expanded
+    SearchResult Search(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path = NULL);
+
+    // Same search in a caller's scratch, safe to run from several threads at once with a scratch each
+    SearchResult Search(const Grid &grid, int startIndex, int endIndex, std::vector<int> *path, HpaQueryScratch &query) const;
+
+    int ClusterOf(const Grid &grid, int index) const
+    {
+        return (grid.Y(index) / HPA_CLUSTER_SIZE) * clusterCols + grid.X(index) / HPA_CLUSTER_SIZE;
+    }
+
+    std::vector<int> ClusterNodes(const Grid &grid, int cluster) const;
+    int FindNode(int cluster, int index) const;
+    void LinkCluster(const Grid &grid, int cluster);
+    void ComputeCosts(const Grid &grid, int cluster, HpaScratch &buffers);
+
+    // Runs body(cluster, scratch) for every listed cluster, on the pool when given one
+    void ForEachCluster(const std::vector<int> &list, ThreadPool *pool, const std::function<void(int cluster, HpaScratch &buffers)> &body);
+
+    // Dijkstra from index limited to its cluster, reverse searches toward index instead. Returns the cells expanded
+    int SearchCluster(const Grid &grid, int cluster, int index, bool reverse, HpaScratch &buffers) const;
+    int LocalIndex(const Grid &grid, int cluster, int index) const;
+
+    // Appends the cells of the last SearchCluster path between its source and index, the path already ends with the
+    // source for forward searches and with index for reverse ones
+    void TraceCluster(const Grid &grid, int cluster, int index, bool reverse, const HpaScratch &buffers, std::vector<int> &path) const;
+};
+
+// Runs every query against the graph on the pool like SolveBatch, each worker searching in its own query scratch.
+// Queries found in the cache are not searched, the rest are stored in it with their paths under HPA_CACHE_ALGORITHM
+std::vector<SearchResult> SolveBatch(ThreadPool &pool, const HierarchicalGraph &graph, const Grid &grid, const std::vector<BatchQuery> &queries,
+                                     PathCache *cache = NULL);
+
+#endif
@@ -0,0 +1,235 @@
+#include "pv_landmarks.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Dijkstra buckets, one more than the largest cost a byte can hold
+#define LANDMARK_BUCKET_COUNT 256
+
+// Leads every table file, bump the digit when the layout changes
+#define LANDMARK_FILE_MAGIC "PVALT2"
+
+// FNV-1a over the bytes of a buffer
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t GridChecksum(const Grid &grid)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    int size[2] = {grid.rows, grid.cols};
+
+    hash = HashBytes(hash, size, sizeof(size));
+    hash = HashBytes(hash, grid.walls.data(), grid.walls.size() * sizeof(uint64_t));
+    hash = HashBytes(hash, grid.costs.data(), grid.costs.size());
+    return hash;
+}
+
+// Dial's algorithm from source over the whole grid. Costs are at least one and below the bucket count, so a cell is
+// never pushed into the bucket being drained
+static void LandmarkDijkstra(const Grid &grid, int source, std::vector<int32_t> &distance, std::vector<std::vector<int>> &buckets)
+{
+    distance.assign(grid.Size(), LANDMARK_UNREACHABLE);
+    distance[source] = 0;
+    buckets[0].push_back(source);
+
+    int pending = 1;
+
+    for (int current = 0; pending > 0; current++)
+    {
+        std::vector<int> &bucket = buckets[current % LANDMARK_BUCKET_COUNT];
+
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            int index = bucket[i];
+            pending--;
+
+            // Stale entry, the cell was reached cheaper after it was pushed
+            if (distance[index] != current)
+            {
+                continue;
+            }
+
+            for (int j = 0; j < 4; j++)
+            {
+                int neighbourIndex = index + grid.offsets[j];
+                int newDistance = current + grid.costs[neighbourIndex];
+
+                if (!grid.IsWall(neighbourIndex) && newDistance < distance[neighbourIndex])
+                {
+                    distance[neighbourIndex] = newDistance;
+                    buckets[newDistance % LANDMARK_BUCKET_COUNT].push_back(neighbourIndex);
+                    pending++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+}
+
+bool LandmarkTable::Build(const Grid &grid, int count)
+{
+    requested = count;
+    count = std::max(1, std::min(count, LANDMARK_MAX_COUNT));
+
+    rows = grid.rows;
+    cols = grid.cols;
+    checksum = GridChecksum(grid);
+    landmarks.clear();
+
+    int seed = -1;
+    for (int index = 0; index < grid.Size() && seed == -1; index++)
+    {
+        if (!grid.IsWall(index))
+        {
+            seed = index;
+        }
+    }
+    if (seed == -1)
+    {
+        this->count = 0;
+        distances.clear();
+        return false;
+    }
+
+    std::vector<std::vector<int>> buckets(LANDMARK_BUCKET_COUNT);
+    std::vector<int32_t> column;
+    std::vector<int32_t> nearest;
+
+    // The seed only serves to find the first landmark, the farthest cell from it
+    LandmarkDijkstra(grid, seed, column, buckets);
+    nearest = column;
+
+    this->count = count;
+    distances.assign((size_t)grid.Size() * count, LANDMARK_UNREACHABLE);
+
+    for (int k = 0; k < count; k++)
+    {
+        // Farthest point, the reached cell whose nearest landmark is farthest away
+        int landmark = -1;
+        int farthest = k == 0 ? -1 : 0;
+
+        for (int index = 0; index < grid.Size(); index++)
+        {
+            if (nearest[index] != LANDMARK_UNREACHABLE && nearest[index] > farthest)
+            {
+                farthest = nearest[index];
+                landmark = index;
+            }
+        }
+
+        // Every reached cell is already a landmark
+        if (landmark == -1)
+        {
+            break;
+        }
+
+        landmarks.push_back(landmark);
+        LandmarkDijkstra(grid, landmark, column, buckets);
+
+        for (int index = 0; index < grid.Size(); index++)
+        {
+            distances[(size_t)index * count + k] = column[index];
+            if (k == 0 || column[index] < nearest[index])
+            {
+                nearest[index] = column[index];
+            }
+        }
+    }
+
+    // Small regions run out of landmarks, close the gaps left in every cell
+    int found = landmarks.size();
+    if (found < count)
+    {
+        for (int index = 0; index < grid.Size(); index++)
+        {
+            memmove(&distances[(size_t)index * found], &distances[(size_t)index * count], found * sizeof(int32_t));
+        }
+        distances.resize((size_t)grid.Size() * found);
+        this->count = found;
+    }
+    return true;
+}
+
+bool LandmarkTable::Matches(const Grid &grid) const
+{
+    return count > 0 && rows == grid.rows && cols == grid.cols && checksum == GridChecksum(grid);
+}
+
+// The file holds the magic, rows, cols, count, requested count and checksum, then the landmarks and the distances in memory order
+bool LandmarkTable::Save(const char *fileName) const
+{
+    FILE *file = fopen(fileName, "wb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    int32_t header[4] = {rows, cols, count, requested};
+    std::vector<int32_t> landmarkCells(landmarks.begin(), landmarks.end());
+
+    fwrite(LANDMARK_FILE_MAGIC, 1, sizeof(LANDMARK_FILE_MAGIC), file);
+    fwrite(header, sizeof(int32_t), 4, file);
+    fwrite(&checksum, sizeof(checksum), 1, file);
+    fwrite(landmarkCells.data(), sizeof(int32_t), landmarkCells.size(), file);
+    fwrite(distances.data(), sizeof(int32_t), distances.size(), file);
+
+    bool written = !ferror(file);
+    return fclose(file) == 0 && written;
+}
+
+bool LandmarkTable::Load(const char *fileName, const Grid &grid)
+{
+    FILE *file = fopen(fileName, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    char magic[sizeof(LANDMARK_FILE_MAGIC)];
+    int32_t header[4];
+    uint64_t fileChecksum;
+
+    bool valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, LANDMARK_FILE_MAGIC, sizeof(magic)) == 0 &&
+                 fread(header, sizeof(int32_t), 4, file) == 4 && fread(&fileChecksum, sizeof(fileChecksum), 1, file) == 1;
+
+    // Reading the distances is the slow part, so a table for another grid is turned down from its header
+    valid = valid && header[0] == grid.rows && header[1] == grid.cols && header[2] >= 1 && header[2] <= LANDMARK_MAX_COUNT &&
+            fileChecksum == GridChecksum(grid);
+
+    std::vector<int32_t> landmarkCells;
+    std::vector<int32_t> fileDistances;
+
+    if (valid)
+    {
+        landmarkCells.resize(header[2]);
+        fileDistances.resize((size_t)grid.Size() * header[2]);
+        valid = fread(landmarkCells.data(), sizeof(int32_t), landmarkCells.size(), file) == landmarkCells.size() &&
+                fread(fileDistances.data(), sizeof(int32_t), fileDistances.size(), file) == fileDistances.size();
+    }
+    fclose(file);
+
+    if (!valid)
+    {
+        return false;
+    }
+
+    rows = header[0];
+    cols = header[1];
+    count = header[2];
+    requested = header[3];
+    checksum = fileChecksum;
+    landmarks.assign(landmarkCells.begin(), landmarkCells.end());
+    distances.swap(fileDistances);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef PV_LANDMARKS_H
+#define PV_LANDMARKS_H
+
+#include "pv_grid.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+// Landmarks picked when none are asked for
+#define LANDMARK_DEFAULT_COUNT 8
+
+// Most landmarks a table holds, the distances of one cell stay within a cache line
+#define LANDMARK_MAX_COUNT 16
+
+// Distance of a cell the landmark cannot reach
+#define LANDMARK_UNREACHABLE INT32_MAX
+
+// Distances from a few landmark cells to every cell, for the ALT lower bound. By the triangle inequality the cost from v
+// to t is at least d(L, t) - d(L, v), and since a reversed path costs c[start] - c[end] more it is also at least
+// d(L, v) - d(L, t) + c[t] - c[v]. Landmarks are spread by farthest point over the region reached from the first open
+// cell, so they sit at dead ends and corners where the bounds are tight.
+//
+// Distances are stored per cell, the count distances of cell i start at distances[i * count]
+struct LandmarkTable
+{
+    int rows;
+    int cols;
+    int count;
+
+    // Count asked of Build, which can pick fewer landmarks, so a saved table is still known to answer the same request
+    int requested;
+    uint64_t checksum;
+    std::vector<int> landmarks;
+    std::vector<int32_t> distances;
+
+    LandmarkTable() : rows(0), cols(0), count(0), requested(0), checksum(0) {}
+
+    // Picks count landmarks and runs Dijkstra from each, returns false when the grid has no open cell
+    bool Build(const Grid &grid, int count = LANDMARK_DEFAULT_COUNT);
+
+    // True when the table was built for this grid, any edit to a wall or weight makes it stale
+    bool Matches(const Grid &grid) const;
+
+    // Tables are binary files saved next to the map, Load fails on a file written for another grid
+    bool Save(const char *fileName) const;
+    bool Load(const char *fileName, const Grid &grid);
+
+    const int32_t *Distances(int index) const
+    {
+        return &distances[(size_t)index * count];
+    }
+
+    // Lower bound on the cost from index to the end, targetDistances are Distances(endIndex)
+    int Estimate(const Grid &grid, int index, int endIndex, const int32_t *targetDistances) const
+    {
+        const int32_t *source = Distances(index);
+        int costDifference = grid.costs[endIndex] - grid.costs[index];
+        int bound = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (source[i] == LANDMARK_UNREACHABLE || targetDistances[i] == LANDMARK_UNREACHABLE)
+            {
+                continue;
+            }
+            int forward = targetDistances[i] - source[i];
+            int backward = source[i] - targetDistances[i] + costDifference;
+            bound = std::max(bound, std::max(forward, backward));
+        }
+        return bound;
+    }
+};
+
+// Hash of the size, walls and costs of a grid
+uint64_t GridChecksum(const Grid &grid);
+
+#endif
@@ -0,0 +1,675 @@
+#include "pv_parallel.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <stddef.h>
+
+// Polls before an idle worker goes to sleep, or before Run stops spinning and waits for the workers
+#define WORKER_SPIN_COUNT 4096
+
+// Frontier cells per chunk, smaller frontiers are expanded on the calling thread alone
+#define BFS_CELL_GRAIN 4096
+// Bitmap words per chunk when scanning the whole grid
+#define BFS_WORD_GRAIN 256
+
+// Direction switch thresholds after Beamer et al. Go bottom up once the edges out of the frontier exceed the
+// unvisited cells divided by alpha, and back to top down once the frontier is smaller than all cells divided by beta
+#define BOTTOM_UP_ALPHA 14
+#define BOTTOM_UP_BETA 24
+
+ThreadPool::ThreadPool(int workers) : generation(0), busy(0), stopping(false), task(NULL)
+{
+    if (workers <= 0)
+    {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 1; i < workers; i++)
+    {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Run(const std::function<void(int)> &task)
+{
+    if (threads.empty())
+    {
+        task(0);
+        return;
+    }
+
+    this->task = &task;
+    busy.store(threads.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    task(0);
+
+    for (int i = 0; i < WORKER_SPIN_COUNT && busy.load(std::memory_order_acquire) > 0; i++)
+    {
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy.load(std::memory_order_acquire) == 0; });
+}
+
+void ThreadPool::WorkerLoop(int worker)
+{
+    unsigned int seen = 0;
+
+    while (true)
+    {
+        for (int i = 0; i < WORKER_SPIN_COUNT && generation.load(std::memory_order_acquire) == seen; i++)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return generation.load(std::memory_order_acquire) != seen; });
+
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation.load(std::memory_order_relaxed);
+        }
+
+        (*task)(worker);
+
+        // The last worker to finish wakes Run
+        if (busy.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(int count, int grain, const std::function<void(int begin, int end, int worker)> &body)
+{
+    // Not worth waking the workers for a single chunk
+    if (count <= grain || threads.empty())
+    {
+        if (count > 0)
+        {
+            body(0, count, 0);
+        }
+        return;
+    }
+
+    std::atomic<int> next(0);
+
+    Run([&](int worker) {
+        for (int begin = next.fetch_add(grain, std::memory_order_relaxed); begin < count; begin = next.fetch_add(grain, std::memory_order_relaxed))
+        {
+            body(begin, std::min(begin + grain, count), worker);
+        }
+    });
+}
+
+// Work stealing ranges pack begin in the low and end in the high half, so both change in one compare and swap
+static uint64_t PackRange(int begin, int end)
+{
+    return (uint64_t)(uint32_t)begin | (uint64_t)end << 32;
+}
+
+static int RangeBegin(uint64_t range)
+{
+    return (int)(uint32_t)range;
+}
+
+static int RangeEnd(uint64_t range)
+{
+    return (int)(range >> 32);
+}
+
+void ThreadPool::ParallelForStealing(int count, const std::function<void(int index, int worker)> &body)
+{
+    int workers = Size();
+    std::vector<std::atomic<uint64_t>> ranges(workers);
+
+    for (int worker = 0; worker < workers; worker++)
+    {
+        ranges[worker].store(PackRange((long long)count * worker / workers, (long long)count * (worker + 1) / workers), std::memory_order_relaxed);
+    }
+
+    Run([&](int worker) {
+        std::atomic<uint64_t> &own = ranges[worker];
+
+        while (true)
+        {
+            // The owner takes from the front, so it only races thieves for the last index
+            uint64_t range = own.load(std::memory_order_acquire);
+            while (RangeBegin(range) < RangeEnd(range))
+            {
+                if (own.compare_exchange_weak(range, PackRange(RangeBegin(range) + 1, RangeEnd(range)), std::memory_order_acq_rel))
+                {
+                    body(RangeBegin(range), worker);
+                    range = own.load(std::memory_order_acquire);
+                }
+            }
+
+            // Out of work, steal the back half of the first share found. Stolen indexes are never handed back, so once
+            // every share is empty the rest is already running
+            bool stolen = false;
+            for (int i = 1; i < workers && !stolen; i++)
+            {
+                std::atomic<uint64_t> &victim = ranges[(worker + i) % workers];
+                uint64_t victimRange = victim.load(std::memory_order_acquire);
+
+                while (!stolen && RangeBegin(victimRange) < RangeEnd(victimRange))
+                {
+                    int begin = RangeBegin(victimRange);
+                    int end = RangeEnd(victimRange);
+                    int middle = end - (end - begin + 1) / 2;
+
+                    if (victim.compare_exchange_weak(victimRange, PackRange(begin, middle), std::memory_order_acq_rel))
+                    {
+                        own.store(PackRange(middle, end), std::memory_order_release);
+                        stolen = true;
+                    }
+                }
+            }
+
+            if (!stolen)
+            {
+                return;
+            }
+        }
+    });
+}
+
+std::vector<SearchResult> SolveBatch(ThreadPool &pool, const Grid &grid, const std::vector<BatchQuery> &queries, SearchType type, QueueBackend backend,
+                                     PathCache *cache)
+{
+    std::vector<SearchResult> results(queries.size());
+    std::vector<SearchScratch> scratch(pool.Size());
+    std::vector<std::vector<int>> paths(pool.Size());
+
+    // One JPS+ table serves every worker, rather than each worker building its own in its scratch
+    JumpTable jumpTable;
+    if (type == searchJumpPointPlus)
+    {
+        jumpTable.Build(grid);
+    }
+
+    pool.ParallelForStealing(queries.size(), [&](int index, int worker) {
+        const BatchQuery &query = queries[index];
+
+        if (grid.IsWall(query.startIndex) || grid.IsWall(query.endIndex))
+        {
+            results[index] = {false, 0, 0, 0};
+            return;
+        }
+
+        if (cache != NULL && cache->Find(grid, query.startIndex, query.endIndex, type, results[index]))
+        {
+            return;
+        }
+
+        std::unique_ptr<SearchStepper> stepper = type == searchJumpPointPlus
+                                                     ? CreateJumpPointPlusStepper(jumpTable, grid, query.startIndex, query.endIndex, NULL, &scratch[worker])
+                                                     : CreateSearchStepper(type, grid, query.startIndex, query.endIndex, backend, NULL, &scratch[worker]);
+        stepper->Step(LLONG_MAX);
+        results[index] = stepper->result;
+
+        if (cache != NULL)
+        {
+            stepper->TracePath(paths[worker]);
+            cache->Insert(grid, query.startIndex, query.endIndex, type, stepper->result, &paths[worker]);
+        }
+    });
+    return results;
+}
+
+typedef std::vector<std::atomic<uint64_t>> AtomicBitmap;
+
+static bool TestBit(const AtomicBitmap &bitmap, int index)
+{
+    return (bitmap[index >> 6].load(std::memory_order_relaxed) >> (index & 63)) & 1;
+}
+
+// Level marks cycle through 1, 2 and 3, 0 is unreached
+static uint8_t LevelMark(int level)
+{
+    return level % 3 + 1;
+}
+
+// Gathers the cells found by every worker into one frontier list
+static void GatherFrontier(ThreadPool &pool, std::vector<std::vector<int>> &lists, std::vector<int> &frontier, long long count)
+{
+    std::vector<size_t> offsets(lists.size() + 1, 0);
+
+    for (size_t i = 0; i < lists.size(); i++)
+    {
+        offsets[i + 1] = offsets[i] + lists[i].size();
+    }
+    frontier.resize(count);
+
+    auto copy = [&](int worker) {
+        std::copy(lists[worker].begin(), lists[worker].end(), frontier.begin() + offsets[worker]);
+        lists[worker].clear();
+    };
+
+    if (count < BFS_CELL_GRAIN)
+    {
+        for (size_t i = 0; i < lists.size(); i++)
+        {
+            copy(i);
+        }
+    }
+    else
+    {
+        pool.Run(copy);
+    }
+}
+
+SearchResult ParallelBreadthFirstSearch(ThreadPool &pool, const Grid &grid, int startIndex, int endIndex)
+{
+    SearchResult result = {false, 0, 0, 0};
+    int size = grid.Size();
+    int wordCount = grid.walls.size();
+    int workers = pool.Size();
+
+    // Walls start out visited below, so a walled end would look reached
+    if (grid.IsWall(startIndex) || (endIndex != -1 && grid.IsWall(endIndex)))
+    {
+        return result;
+    }
+
+    // Walls, the border and the bits past the last cell start out visited, so neither direction needs a wall test
+    AtomicBitmap visited(wordCount);
+    AtomicBitmap frontierBits;
+    AtomicBitmap nextBits;
+    std::vector<long long> openCounts(workers, 0);
+
+    pool.ParallelFor(wordCount, BFS_WORD_GRAIN, [&](int begin, int end, int worker) {
+        for (int w = begin; w < end; w++)
+        {
+            uint64_t word = grid.walls[w];
+            if (w == wordCount - 1 && size % 64 != 0)
+            {
+                word |= ~0ULL << (size % 64);
+            }
+
+            visited[w].store(word, std::memory_order_relaxed);
+            openCounts[worker] += 64 - __builtin_popcountll(word);
+        }
+    });
+
+    long long openCells = 0;
+    for (long long count : openCounts)
+    {
+        openCells += count;
+    }
+
+    // Level of every reached cell modulo 3. Neighbouring cells are at most one level apart, so the mark is enough
+    // to step back from the end one level at a time. Flooding has no path to recover and skips it
+    std::vector<uint8_t> levels;
+    if (endIndex != -1)
+    {
+        levels.assign(size, 0);
+    }
+    uint8_t *levelData = levels.empty() ? NULL : levels.data();
+
+    visited[startIndex >> 6].fetch_or(1ULL << (startIndex & 63), std::memory_order_relaxed);
+    if (levelData != NULL)
+    {
+        levelData[startIndex] = LevelMark(0);
+    }
+
+    std::vector<int> frontier(1, startIndex);
+    std::vector<std::vector<int>> lists(workers);
+    long long frontierCount = 1;
+    long long reached = 1;
+    bool bottomUp = false;
+
+    for (int level = 1; frontierCount > 0 && (endIndex == -1 || !TestBit(visited, endIndex)); level++)
+    {
+        uint8_t mark = LevelMark(level);
+
+        if (bottomUp)
+        {
+            // Every unvisited cell looks for a neighbour in the frontier, each worker owns the words it scans
+            pool.ParallelFor(wordCount, BFS_WORD_GRAIN, [&](int begin, int end, int worker) {
+                std::vector<int> &next = lists[worker];
+
+                for (int w = begin; w < end; w++)
+                {
+                    uint64_t seen = visited[w].load(std::memory_order_relaxed);
+                    uint64_t open = ~seen;
+                    uint64_t found = 0;
+
+                    while (open != 0)
+                    {
+                        int bit = __builtin_ctzll(open);
+                        int index = w * 64 + bit;
+                        open &= open - 1;
+
+                        for (int i = 0; i < 4; i++)
+                        {
+                            if (TestBit(frontierBits, index + grid.offsets[i]))
+                            {
+                                found |= 1ULL << bit;
+                                next.push_back(index);
+                                if (levelData != NULL)
+                                {
+                                    levelData[index] = mark;
+                                }
+                                break;
+                            }
+                        }
+                    }
+
+                    nextBits[w].store(found, std::memory_order_relaxed);
+                    if (found != 0)
+                    {
+                        visited[w].store(seen | found, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        else
+        {
+            // Every frontier cell claims its unvisited neighbours, the atomic or decides which worker gets a cell
+            pool.ParallelFor(frontier.size(), BFS_CELL_GRAIN, [&](int begin, int end, int worker) {
+                std::vector<int> &next = lists[worker];
+
+                for (int i = begin; i < end; i++)
+                {
+                    for (int j = 0; j < 4; j++)
+                    {
+                        int neighbourIndex = frontier[i] + grid.offsets[j];
+                        uint64_t bit = 1ULL << (neighbourIndex & 63);
+                        std::atomic<uint64_t> &word = visited[neighbourIndex >> 6];
+
+                        if ((word.load(std::memory_order_relaxed) & bit) == 0 && (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0)
+                        {
+                            next.push_back(neighbourIndex);
+                            if (levelData != NULL)
+                            {
+                                levelData[neighbourIndex] = mark;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        frontierCount = 0;
+        for (const std::vector<int> &next : lists)
+        {
+            frontierCount += next.size();
+        }
+        reached += frontierCount;
+
+        bool nextBottomUp = bottomUp ? frontierCount >= openCells / BOTTOM_UP_BETA : frontierCount * 4 > (openCells - reached) / BOTTOM_UP_ALPHA;
+
+        if (!nextBottomUp)
+        {
+            GatherFrontier(pool, lists, frontier, frontierCount);
+        }
+        else if (bottomUp)
+        {
+            frontierBits.swap(nextBits);
+            for (std::vector<int> &next : lists)
+            {
+                next.clear();
+            }
+        }
+        else
+        {
+            // Switching to bottom up, turn the lists into a bitmap
+            if (frontierBits.empty())
+            {
+                frontierBits = AtomicBitmap(wordCount);
+                nextBits = AtomicBitmap(wordCount);
+            }
+
+            pool.ParallelFor(wordCount, BFS_WORD_GRAIN, [&](int begin, int end, int) {
+                for (int w = begin; w < end; w++)
+                {
+                    frontierBits[w].store(0, std::memory_order_relaxed);
+                }
+            });
+            pool.Run([&](int worker) {
+                for (int index : lists[worker])
+                {
+                    frontierBits[index >> 6].fetch_or(1ULL << (index & 63), std::memory_order_relaxed);
+                }
+                lists[worker].clear();
+            });
+        }
+        bottomUp = nextBottomUp;
+    }
+
+    result.expansions = reached;
+
+    if (endIndex == -1 || !TestBit(visited, endIndex))
+    {
+        return result;
+    }
+
+    // Walk back from the end through neighbours one level closer to the start
+    result.found = true;
+    int index = endIndex;
+
+    while (index != startIndex)
+    {
+        uint8_t previousMark = (levelData[index] + 1) % 3 + 1;
+
+        for (int i = 0; i < 4; i++)
+        {
+            int neighbourIndex = index + grid.offsets[i];
+            if (!grid.IsWall(neighbourIndex) && levelData[neighbourIndex] == previousMark)
+            {
+                result.pathLength++;
+                result.pathCost += grid.costs[index];
+                index = neighbourIndex;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+static long long BucketSize(const std::vector<std::vector<int>> &lists)
+{
+    long long size = 0;
+
+    for (const std::vector<int> &list : lists)
+    {
+        size += list.size();
+    }
+    return size;
+}
+
+SearchResult DeltaSteppingSearch(ThreadPool &pool, const Grid &grid, int startIndex, int endIndex, int delta)
+{
+    SearchResult result = {false, 0, 0, 0};
+    int size = grid.Size();
+    int workers = pool.Size();
+
+    if (delta <= 0)
+    {
+        delta = DELTA_STEPPING_DEFAULT_DELTA;
+    }
+
+    // Distances only grow by the largest cost past the bucket being drained, so the buckets are reused cyclically
+    int slots = grid.MaxCost() / delta + 2;
+    std::vector<std::vector<std::vector<int>>> buckets(slots, std::vector<std::vector<int>>(workers));
+    std::vector<std::vector<int>> settled(workers);
+    std::vector<long long> expansions(workers, 0);
+    std::vector<int> frontier;
+
+    if (grid.IsWall(startIndex) || (endIndex != -1 && grid.IsWall(endIndex)))
+    {
+        return result;
+    }
+
+    std::vector<std::atomic<int>> distances(size);
+    pool.ParallelFor(size, BFS_CELL_GRAIN, [&](int begin, int end, int) {
+        for (int i = begin; i < end; i++)
+        {
+            distances[i].store(INT_MAX, std::memory_order_relaxed);
+        }
+    });
+
+    // Lowers the distance of a cell with a compare and swap loop, the worker that lowers it queues it again
+    auto relax = [&](int index, int distance, int worker) {
+        int current = distances[index].load(std::memory_order_relaxed);
+
+        while (distance < current)
+        {
+            if (distances[index].compare_exchange_weak(current, distance, std::memory_order_relaxed))
+            {
+                buckets[(distance / delta) % slots][worker].push_back(index);
+                return;
+            }
+        }
+    };
+
+    distances[startIndex].store(0, std::memory_order_relaxed);
+    buckets[0][0].push_back(startIndex);
+
+    for (int bucket = 0;; bucket++)
+    {
+        int slot = bucket % slots;
+        long long count = BucketSize(buckets[slot]);
+
+        // Skip to the next bucket with cells, every bucket being empty means the search is done
+        if (count == 0)
+        {
+            int skip = 1;
+            while (skip < slots && BucketSize(buckets[(bucket + skip) % slots]) == 0)
+            {
+                skip++;
+            }
+            if (skip == slots)
+            {
+                break;
+            }
+
+            bucket += skip;
+            slot = bucket % slots;
+            count = BucketSize(buckets[slot]);
+        }
+
+        // Cheap edges can put cells back into this bucket, so it is drained until it stays empty
+        while (count > 0)
+        {
+            GatherFrontier(pool, buckets[slot], frontier, count);
+
+            pool.ParallelFor(frontier.size(), BFS_CELL_GRAIN, [&](int begin, int end, int worker) {
+                for (int i = begin; i < end; i++)
+                {
+                    int index = frontier[i];
+                    int distance = distances[index].load(std::memory_order_relaxed);
+
+                    // Copies left behind when a cell moved to a lower bucket
+                    if (distance / delta != bucket)
+                    {
+                        continue;
+                    }
+
+                    expansions[worker]++;
+                    settled[worker].push_back(index);
+
+                    for (int j = 0; j < 4; j++)
+                    {
+                        int neighbourIndex = index + grid.offsets[j];
+                        int cost = grid.costs[neighbourIndex];
+
+                        if (!grid.IsWall(neighbourIndex) && cost <= delta)
+                        {
+                            relax(neighbourIndex, distance + cost, worker);
+                        }
+                    }
+                }
+            });
+            count = BucketSize(buckets[slot]);
+        }
+
+        // Expensive edges always land in a later bucket, so they are relaxed once from the final distances
+        GatherFrontier(pool, settled, frontier, BucketSize(settled));
+
+        pool.ParallelFor(frontier.size(), BFS_CELL_GRAIN, [&](int begin, int end, int worker) {
+            for (int i = begin; i < end; i++)
+            {
+                int index = frontier[i];
+                int distance = distances[index].load(std::memory_order_relaxed);
+
+                for (int j = 0; j < 4; j++)
+                {
+                    int neighbourIndex = index + grid.offsets[j];
+                    int cost = grid.costs[neighbourIndex];
+
+                    if (!grid.IsWall(neighbourIndex) && cost > delta)
+                    {
+                        relax(neighbourIndex, distance + cost, worker);
+                    }
+                }
+            }
+        });
+
+        // Everything below the next bucket is final
+        if (endIndex != -1 && distances[endIndex].load(std::memory_order_relaxed) / delta <= bucket)
+        {
+            break;
+        }
+    }
+
+    for (long long count : expansions)
+    {
+        result.expansions += count;
+    }
+
+    if (endIndex == -1 || distances[endIndex].load(std::memory_order_relaxed) == INT_MAX)
+    {
+        return result;
+    }
+
+    // Walk back through neighbours whose distance plus the cost of the current cell gives its distance
+    result.found = true;
+    int index = endIndex;
+
+    while (index != startIndex)
+    {
+        int distance = distances[index].load(std::memory_order_relaxed);
+
+        for (int i = 0; i < 4; i++)
+        {
+            int neighbourIndex = index + grid.offsets[i];
+            int neighbourDistance = distances[neighbourIndex].load(std::memory_order_relaxed);
+
+            if (!grid.IsWall(neighbourIndex) && neighbourDistance != INT_MAX && neighbourDistance + grid.costs[index] == distance)
+            {
+                result.pathLength++;
+                result.pathCost += grid.costs[index];
+                index = neighbourIndex;
+                break;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef PV_PARALLEL_H
+#define PV_PARALLEL_H
+
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+#include "pv_cache.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bucket width used by delta-stepping when none is given
+#define DELTA_STEPPING_DEFAULT_DELTA 4
+
+// Fixed set of worker threads that run one parallel loop at a time, the calling thread takes part as worker 0.
+// Idle workers spin briefly before sleeping so back to back loops, like the levels of a BFS, start quickly
+struct ThreadPool
+{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::atomic<unsigned int> generation;
+    std::atomic<int> busy;
+    bool stopping;
+    const std::function<void(int)> *task;
+
+    // Zero workers uses one per hardware thread
+    ThreadPool(int workers = 0);
+    ~ThreadPool();
+
+    int Size() const
+    {
+        return threads.size() + 1;
+    }
+
+    // Runs task(worker) once on every worker and waits for all of them
+    void Run(const std::function<void(int)> &task);
+
+    // Splits [0, count) into chunks of grain handed out on demand, body gets a chunk and the worker running it
+    void ParallelFor(int count, int grain, const std::function<void(int begin, int end, int worker)> &body);
+
+    // Runs body once for every index in [0, count). Each worker starts with an even share and takes from its front,
+    // a worker that runs dry steals the back half of another worker's share. For items of very uneven cost
+    void ParallelForStealing(int count, const std::function<void(int index, int worker)> &body);
+
+    void WorkerLoop(int worker);
+};
+
+// Level synchronous BFS over the pool. Small frontiers are expanded top down from a list of cells, large ones
+// bottom up by scanning the unvisited bitmap for cells next to the frontier bitmap. Only the path is reported,
+// an endIndex of -1 floods every cell reachable from the start and reports how many were reached as expansions
+SearchResult ParallelBreadthFirstSearch(ThreadPool &pool, const Grid &grid, int startIndex, int endIndex);
+
+// Delta-stepping shortest paths over the pool, finds the same path cost as Dijkstra. Cells are kept in buckets of
+// delta distances, each worker filling its own buckets. A bucket is drained in parallel phases that relax the cheap
+// edges (cost at most delta) until it stays empty, then the expensive edges out of everything it settled are relaxed
+// once. A delta of 0 picks DELTA_STEPPING_DEFAULT_DELTA
+SearchResult DeltaSteppingSearch(ThreadPool &pool, const Grid &grid, int startIndex, int endIndex, int delta = 0);
+
+// Start and end cell of one query in a batch
+struct BatchQuery
+{
+    int startIndex;
+    int endIndex;
+};
+
+// Runs every query against the same grid on the pool, results are in query order. Each worker lends its own scratch
+// to the searches it runs, so the labels, states and queues are allocated once per worker instead of once per query,
+// and a JPS+ batch builds its jump table once.
+// Queries found in the cache are not searched, the rest are stored in it with their paths
+std::vector<SearchResult> SolveBatch(ThreadPool &pool, const Grid &grid, const std::vector<BatchQuery> &queries, SearchType type,
+                                     QueueBackend backend = queueAuto, PathCache *cache = NULL);
+
+#endif
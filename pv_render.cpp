@@ -0,0 +1,405 @@
+#include "pv_render.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+
+// Colors indexed by CellCode, the search from the end of a bidirectional search is drawn in purple
+static const Color cellPalette[CELL_CODE_WEIGHTED] = {RAYWHITE, {190, 228, 255, 255}, SKYBLUE, GOLD, {228, 208, 255, 255}, {180, 140, 240, 255}, BEIGE, GREEN, RED, DARKGRAY};
+
+// Weighted cells are drawn at this opacity over the window background
+#define WEIGHTED_ALPHA .6f
+
+// Uses the default raylib vertex shader, which passes fragTexCoord through
+static const char *gridFragmentShader = R"(
+#version 330
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+uniform vec4 palette[32];
+uniform vec2 gridSize;
+uniform float cellSize;
+
+out vec4 finalColor;
+
+void main()
+{
+    int code = int(texture(texture0, fragTexCoord).r * 255.0 + 0.5);
+    vec4 color = palette[code & 31];
+
+    // Cell borders, hidden once cells get too small for them to be readable
+    vec2 pixel = fract(fragTexCoord * gridSize) * cellSize;
+    if (cellSize >= 4.0 && (min(pixel.x, pixel.y) < 1.0 || max(pixel.x, pixel.y) > cellSize - 1.0))
+    {
+        color = vec4(0.0, 0.0, 0.0, 1.0);
+    }
+
+    finalColor = color;
+}
+)";
+
+uint8_t GetCellCode(const Grid &grid, int index, int startIndex, int endIndex)
+{
+    if (index == startIndex)
+    {
+        return cellCodeStart;
+    }
+    if (index == endIndex)
+    {
+        return cellCodeEnd;
+    }
+    if (grid.IsWall(index))
+    {
+        return cellCodeWall;
+    }
+
+    uint8_t code = grid.states[index];
+
+    // Tint weighted cells
+    if (grid.IsWeighted(index))
+    {
+        code |= CELL_CODE_WEIGHTED;
+    }
+    return code;
+}
+
+void GridRenderer::Load(int rows, int cols)
+{
+    shader = LoadShaderFromMemory(NULL, gridFragmentShader);
+    gridSizeLoc = GetShaderLocation(shader, "gridSize");
+    cellSizeLoc = GetShaderLocation(shader, "cellSize");
+
+    // Weighted colors are blended with the background up front so the quad can be drawn opaque
+    float palette[CELL_CODE_COUNT * 4];
+    Color background = DARKGRAY;
+
+    for (int i = 0; i < CELL_CODE_COUNT; i++)
+    {
+        Color color = cellPalette[i % CELL_CODE_WEIGHTED];
+        float alpha = i >= CELL_CODE_WEIGHTED ? WEIGHTED_ALPHA : 1;
+
+        palette[i * 4] = (color.r * alpha + background.r * (1 - alpha)) / 255;
+        palette[i * 4 + 1] = (color.g * alpha + background.g * (1 - alpha)) / 255;
+        palette[i * 4 + 2] = (color.b * alpha + background.b * (1 - alpha)) / 255;
+        palette[i * 4 + 3] = 1;
+    }
+    SetShaderValueV(shader, GetShaderLocation(shader, "palette"), palette, SHADER_UNIFORM_VEC4, CELL_CODE_COUNT);
+
+    stateTexture = {0};
+    target = {0};
+    Resize(rows, cols);
+}
+
+void GridRenderer::Unload()
+{
+    UnloadTexture(stateTexture);
+    UnloadRenderTexture(target);
+    UnloadShader(shader);
+}
+
+void GridRenderer::Resize(int rows, int cols)
+{
+    this->rows = rows;
+    this->cols = cols;
+
+    if (stateTexture.id != 0)
+    {
+        UnloadTexture(stateTexture);
+    }
+
+    codes.assign((size_t)rows * cols, cellUnvisited);
+    codes.shrink_to_fit();
+
+    dirtyCells.assign(((size_t)rows * cols + 63) / 64, 0);
+    dirtyCells.shrink_to_fit();
+    dirtyRows.clear();
+    rowFirst.assign(rows, cols);
+    rowLast.assign(rows, -1);
+
+    Image image = {codes.data(), cols, rows, 1, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE};
+    stateTexture = LoadTextureFromImage(image);
+    SetTextureFilter(stateTexture, TEXTURE_FILTER_POINT);
+    SetTextureWrap(stateTexture, TEXTURE_WRAP_CLAMP);
+
+    float gridSize[2] = {(float)cols, (float)rows};
+    SetShaderValue(shader, gridSizeLoc, gridSize, SHADER_UNIFORM_VEC2);
+
+    allDirty = true;
+    RepaintAll();
+}
+
+void GridRenderer::RepaintAll()
+{
+    repaintAll = true;
+    repaintBoxes.clear();
+}
+
+void GridRenderer::ClearDirty()
+{
+    for (int y : dirtyRows)
+    {
+        rowFirst[y] = cols;
+        rowLast[y] = -1;
+    }
+    dirtyRows.clear();
+    std::fill(dirtyCells.begin(), dirtyCells.end(), 0);
+}
+
+void GridRenderer::Update(const Grid &grid, int startIndex, int endIndex)
+{
+    // Everything changed, encode and upload the whole texture at once
+    if (allDirty)
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            uint8_t *row = &codes[(size_t)y * cols];
+            int index = grid.Index(0, y);
+
+            for (int x = 0; x < cols; x++)
+            {
+                row[x] = GetCellCode(grid, index + x, startIndex, endIndex);
+            }
+        }
+        UpdateTexture(stateTexture, codes.data());
+
+        ClearDirty();
+        RepaintAll();
+        allDirty = false;
+        return;
+    }
+
+    for (int y : dirtyRows)
+    {
+        int first = rowFirst[y];
+        int last = rowLast[y];
+        uint8_t *row = &codes[(size_t)y * cols];
+        int index = grid.Index(0, y);
+
+        for (int x = first; x <= last; x++)
+        {
+            int cell = y * cols + x;
+            uint64_t bit = 1ULL << (cell & 63);
+
+            if (dirtyCells[cell >> 6] & bit)
+            {
+                row[x] = GetCellCode(grid, index + x, startIndex, endIndex);
+                dirtyCells[cell >> 6] &= ~bit;
+            }
+        }
+
+        // Only the dirty span of the row is uploaded
+        Rectangle span = {(float)first, (float)y, (float)(last - first + 1), 1};
+        UpdateTextureRec(stateTexture, span, row + first);
+
+        if (!repaintAll)
+        {
+            repaintBoxes.push_back({first, last, y, y});
+        }
+
+        rowFirst[y] = cols;
+        rowLast[y] = -1;
+    }
+    dirtyRows.clear();
+}
+
+void GridRenderer::Draw(Rectangle gridRegion)
+{
+    int width = gridRegion.width;
+    int height = gridRegion.height;
+
+    // The shaded grid is kept at screen resolution, recreate it when the grid region changes size
+    if (target.id == 0 || target.texture.width != width || target.texture.height != height)
+    {
+        if (target.id != 0)
+        {
+            UnloadRenderTexture(target);
+        }
+        target = LoadRenderTexture(width, height);
+        RepaintAll();
+    }
+
+    if (repaintAll)
+    {
+        repaintBoxes.assign(1, {0, cols - 1, 0, rows - 1});
+    }
+
+    // Shade only the changed row spans, rows next to each other with the same span share a quad. The quads use one
+    // texture and shader, so raylib sends them in a single batch
+    if (!repaintBoxes.empty())
+    {
+        float cellWidth = (float)width / cols;
+        float cellHeight = (float)height / rows;
+        SetShaderValue(shader, cellSizeLoc, &cellWidth, SHADER_UNIFORM_FLOAT);
+
+        std::sort(repaintBoxes.begin(), repaintBoxes.end(), [](const RepaintBox &a, const RepaintBox &b) { return a.firstRow < b.firstRow; });
+
+        size_t merged = 0;
+        for (size_t i = 1; i < repaintBoxes.size(); i++)
+        {
+            RepaintBox &box = repaintBoxes[merged];
+            const RepaintBox &span = repaintBoxes[i];
+
+            if (span.firstRow == box.lastRow + 1 && span.firstCol == box.firstCol && span.lastCol == box.lastCol)
+            {
+                box.lastRow = span.lastRow;
+            }
+            else
+            {
+                repaintBoxes[++merged] = span;
+            }
+        }
+        repaintBoxes.resize(merged + 1);
+
+        BeginTextureMode(target);
+        BeginShaderMode(shader);
+        for (const RepaintBox &box : repaintBoxes)
+        {
+            Rectangle source = {(float)box.firstCol, (float)box.firstRow, (float)(box.lastCol - box.firstCol + 1), (float)(box.lastRow - box.firstRow + 1)};
+            Rectangle dest = {source.x * cellWidth, source.y * cellHeight, source.width * cellWidth, source.height * cellHeight};
+
+            DrawTexturePro(stateTexture, source, dest, {0, 0}, 0, WHITE);
+        }
+        EndShaderMode();
+        EndTextureMode();
+
+        repaintBoxes.clear();
+    }
+    repaintAll = false;
+
+    // Render textures are stored upside down
+    DrawTextureRec(target.texture, {0, 0, (float)width, (float)-height}, {floorf(gridRegion.x), floorf(gridRegion.y)}, WHITE);
+}
+
+void FlowOverlay::Show(const Grid &grid, const FlowField &field)
+{
+    int maxDistance = 1;
+
+    for (int y = 0; y < grid.rows; y++)
+    {
+        for (int x = 0; x < grid.cols; x++)
+        {
+            int distance = field.distances[grid.Index(x, y)];
+            if (distance != FLOW_UNREACHABLE)
+            {
+                maxDistance = std::max(maxDistance, distance);
+            }
+        }
+    }
+
+    // A new texture is only needed when the grid size changed
+    if (heatmap.id != 0 && (grid.rows != rows || grid.cols != cols))
+    {
+        UnloadTexture(heatmap);
+        heatmap = {0};
+    }
+
+    rows = grid.rows;
+    cols = grid.cols;
+    generation = grid.generation;
+    endIndex = field.endIndex;
+    colors.assign((size_t)rows * cols, BLANK);
+    directions.assign((size_t)rows * cols, FLOW_NO_DIRECTION);
+
+    // Near cells are yellow, fading to blue at the far end of the field
+    Color nearColor = {255, 220, 60, FLOW_HEATMAP_ALPHA};
+    Color farColor = {40, 60, 200, FLOW_HEATMAP_ALPHA};
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int index = grid.Index(x, y);
+            int distance = field.distances[index];
+
+            if (distance == FLOW_UNREACHABLE)
+            {
+                continue;
+            }
+
+            float t = (float)distance / maxDistance;
+            Color &color = colors[(size_t)y * cols + x];
+            color.r = nearColor.r + (farColor.r - nearColor.r) * t;
+            color.g = nearColor.g + (farColor.g - nearColor.g) * t;
+            color.b = nearColor.b + (farColor.b - nearColor.b) * t;
+            color.a = FLOW_HEATMAP_ALPHA;
+            directions[(size_t)y * cols + x] = field.directions[index];
+        }
+    }
+
+    if (heatmap.id == 0)
+    {
+        Image image = {colors.data(), cols, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        heatmap = LoadTextureFromImage(image);
+        SetTextureFilter(heatmap, TEXTURE_FILTER_POINT);
+        SetTextureWrap(heatmap, TEXTURE_WRAP_CLAMP);
+    }
+    else
+    {
+        UpdateTexture(heatmap, colors.data());
+    }
+    visible = true;
+}
+
+void FlowOverlay::Hide()
+{
+    visible = false;
+}
+
+void FlowOverlay::Unload()
+{
+    if (heatmap.id != 0)
+    {
+        UnloadTexture(heatmap);
+        heatmap = {0};
+    }
+    visible = false;
+}
+
+void FlowOverlay::Draw(Rectangle gridRegion)
+{
+    if (!visible)
+    {
+        return;
+    }
+
+    DrawTexturePro(heatmap, {0, 0, (float)cols, (float)rows}, gridRegion, {0, 0}, 0, WHITE);
+
+    float cellWidth = gridRegion.width / cols;
+    float cellHeight = gridRegion.height / rows;
+
+    if (std::min(cellWidth, cellHeight) < FLOW_ARROW_MIN_CELL)
+    {
+        return;
+    }
+
+    // Unit moves indexed by Direction
+    static const Vector2 moves[4] = {{0, -1}, {-1, 0}, {0, 1}, {1, 0}};
+    float length = std::min(cellWidth, cellHeight) * .35f;
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            uint8_t direction = directions[(size_t)y * cols + x];
+            if (direction == FLOW_NO_DIRECTION)
+            {
+                continue;
+            }
+
+            Vector2 move = moves[direction];
+            Vector2 center = {gridRegion.x + (x + .5f) * cellWidth, gridRegion.y + (y + .5f) * cellHeight};
+            Vector2 tail = {center.x - move.x * length, center.y - move.y * length};
+            Vector2 tip = {center.x + move.x * length, center.y + move.y * length};
+
+            // Head lines go back from the tip and out to both sides
+            Vector2 back = {tip.x - move.x * length * .6f, tip.y - move.y * length * .6f};
+            Vector2 side = {-move.y * length * .5f, move.x * length * .5f};
+
+            DrawLineV(tail, tip, BLACK);
+            DrawLineV(tip, {back.x + side.x, back.y + side.y}, BLACK);
+            DrawLineV(tip, {back.x - side.x, back.y - side.y}, BLACK);
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef PV_RENDER_H
+#define PV_RENDER_H
+
+#include "raylib.h"
+#include "pv_grid.h"
+#include "pv_flowfield.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Largest grid side that fits in a single state texture, llvmpipe supports 16384
+#define GRID_TEXTURE_MAX_SIDE 16384
+
+// Palette entries after the CellState values, weighted cells add CELL_CODE_WEIGHTED
+enum CellCode
+{
+    cellCodeWall = cellVisitedReverse + 1,
+    cellCodeStart,
+    cellCodeEnd
+};
+
+#define CELL_CODE_WEIGHTED 16
+#define CELL_CODE_COUNT 32
+
+// Flow field arrows are only drawn once cells are at least this many pixels wide
+#define FLOW_ARROW_MIN_CELL 10
+
+// Opacity of the integration field heatmap over the grid
+#define FLOW_HEATMAP_ALPHA 150
+
+// Palette index of a cell, the start and end cells are drawn over whatever is below them
+uint8_t GetCellCode(const Grid &grid, int index, int startIndex, int endIndex);
+
+// Cells repainted into the render texture by one quad, both ends inclusive
+struct RepaintBox
+{
+    int firstCol;
+    int lastCol;
+    int firstRow;
+    int lastRow;
+};
+
+// Draws the grid through an 8 bit state texture, every cell is a texel and a fragment shader maps it
+// to the palette and draws the cell borders. The shaded grid is kept in a render texture that is blitted
+// once per frame, only cells marked dirty are re-encoded, uploaded and repainted into it, so idle frames
+// cost a single blit
+struct GridRenderer
+{
+    int rows;
+    int cols;
+
+    Texture2D stateTexture;
+    RenderTexture2D target;
+    Shader shader;
+    int gridSizeLoc;
+    int cellSizeLoc;
+
+    // CPU copy of the texture, one byte per cell without the border
+    std::vector<uint8_t> codes;
+
+    // One bit per cell, and the span of dirty columns of every row with a dirty cell
+    std::vector<uint64_t> dirtyCells;
+    std::vector<int> dirtyRows;
+    std::vector<int> rowFirst;
+    std::vector<int> rowLast;
+    bool allDirty;
+
+    // Cells that have to be repainted into the render texture, the dirty span of every row uploaded since the last
+    // draw. Scattered edits repaint only their own rows instead of the box around all of them
+    bool repaintAll;
+    std::vector<RepaintBox> repaintBoxes;
+
+    void Load(int rows, int cols);
+    void Unload();
+    void Resize(int rows, int cols);
+
+    void MarkDirty(int x, int y)
+    {
+        if (allDirty)
+        {
+            return;
+        }
+
+        int cell = y * cols + x;
+        uint64_t bit = 1ULL << (cell & 63);
+
+        if (dirtyCells[cell >> 6] & bit)
+        {
+            return;
+        }
+        dirtyCells[cell >> 6] |= bit;
+
+        if (rowFirst[y] > rowLast[y])
+        {
+            dirtyRows.push_back(y);
+        }
+        rowFirst[y] = x < rowFirst[y] ? x : rowFirst[y];
+        rowLast[y] = x > rowLast[y] ? x : rowLast[y];
+    }
+
+    void MarkAllDirty()
+    {
+        allDirty = true;
+    }
+
+    // Encodes and uploads the dirty cells
+    void Update(const Grid &grid, int startIndex, int endIndex);
+
+    // Repaints the dirty cells into the render texture and blits it
+    void Draw(Rectangle gridRegion);
+
+    void RepaintAll();
+    void ClearDirty();
+};
+
+// Integration field drawn over the grid as a heatmap from the end outward, with the direction of every cell as an arrow
+// once cells are wide enough to hold one. It only matches the grid generation and end it was built for
+struct FlowOverlay
+{
+    int rows;
+    int cols;
+    bool visible;
+    uint64_t generation;
+    int endIndex;
+
+    // One texel per cell, walls and cells that cannot reach the end are transparent
+    Texture2D heatmap;
+    std::vector<Color> colors;
+
+    // Direction field without the border
+    std::vector<uint8_t> directions;
+
+    void Show(const Grid &grid, const FlowField &field);
+    void Hide();
+    void Unload();
+
+    bool IsStale(const Grid &grid, int endIndex) const
+    {
+        return grid.generation != generation || grid.rows != rows || grid.cols != cols || endIndex != this->endIndex;
+    }
+
+    void Draw(Rectangle gridRegion);
+};
+
+#endif
@@ -0,0 +1,686 @@
+#include "pv_grid.h"
+#include "pv_algorithms.h"
+#include "pv_parallel.h"
+#include "pv_bitboard.h"
+#include "pv_hierarchy.h"
+#include "pv_dstar.h"
+#include "pv_landmarks.h"
+#include "pv_flowfield.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+
+// Headless batch solver, runs one maze generator and/or solver at full speed and reports the result
+
+enum SolverTypes
+{
+    solverNone,
+    solverDepthFirstSearch,
+    solverBreadthFirstSearch,
+    solverDijkstra,
+    solverAStar,
+    solverJumpPoint,
+    solverJumpPointPlus,
+    solverBidirectionalBreadthFirstSearch,
+    solverBidirectionalDijkstra,
+    solverBidirectionalAStar,
+    solverParallelBreadthFirstSearch,
+    solverBitboardBreadthFirstSearch,
+    solverDeltaStepping,
+    solverHierarchical,
+    solverReplanning,
+    solverLandmarkAStar,
+    solverFlowField
+};
+
+struct SolveOptions
+{
+    const char *mapFile;
+    const char *saveFile;
+    const char *queryFile;
+    int solver;
+    bool generateMaze;
+    MazeType maze;
+    QueueBackend queue;
+    int rows;
+    int cols;
+    unsigned int seed;
+    int startX;
+    int startY;
+    int endX;
+    int endY;
+    int threads;
+    BitboardEngine engine;
+    int delta;
+    int landmarks;
+    int cacheSize;
+};
+
+void PrintUsage()
+{
+    printf("Usage: pv_solve [options]\n"
+           "  --map FILE            read the grid from a text file ('#' wall, '.' empty, 'w' weighted, 'S' start, 'E' end)\n"
+           "  --maze NAME           generate a maze: prim, dfs or sidewinder\n"
+           "  --size ROWSxCOLS      size of a generated maze (default 50x50)\n"
+           "  --solver NAME         dfs, bfs, dijkstra, astar, jps, jps+, bibfs, bidijkstra, biastar, pbfs, bitbfs,\n"
+           "                        delta, hpa, dstar, alt or flow\n"
+           "  --queue NAME          priority queue for the dijkstra and astar variants: auto, heap or bucket\n"
+           "  --start X,Y           start cell (default first open cell or 'S')\n"
+           "  --end X,Y             end cell (default last open cell or 'E')\n"
+           "  --threads N           worker threads for pbfs, delta, hpa and --queries (default one per hardware thread)\n"
+           "  --engine NAME         word loop for bitbfs: auto, scalar or avx2\n"
+           "  --delta N             bucket width for delta (default %d)\n"
+           "  --landmarks N         landmarks for alt (default %d), the table is kept in the map or save file plus .alt\n"
+           "  --seed N              seed for the maze generators\n"
+           "  --save FILE           write the grid to a text file before solving\n"
+           "  --queries FILE        solve every 'SX,SY EX,EY' line of a file in parallel, with dfs, bfs, dijkstra, astar,\n"
+           "                        jps, jps+, bibfs, bidijkstra, biastar or hpa\n"
+           "  --cache N             keep up to N solved --queries so repeated ones are not searched again (default 0)\n",
+           DELTA_STEPPING_DEFAULT_DELTA, LANDMARK_DEFAULT_COUNT);
+}
+
+int ParseSolver(const char *name)
+{
+    if (strcmp(name, "dfs") == 0)
+    {
+        return solverDepthFirstSearch;
+    }
+    if (strcmp(name, "bfs") == 0)
+    {
+        return solverBreadthFirstSearch;
+    }
+    if (strcmp(name, "dijkstra") == 0)
+    {
+        return solverDijkstra;
+    }
+    if (strcmp(name, "astar") == 0)
+    {
+        return solverAStar;
+    }
+    if (strcmp(name, "jps") == 0)
+    {
+        return solverJumpPoint;
+    }
+    if (strcmp(name, "jps+") == 0)
+    {
+        return solverJumpPointPlus;
+    }
+    if (strcmp(name, "bibfs") == 0)
+    {
+        return solverBidirectionalBreadthFirstSearch;
+    }
+    if (strcmp(name, "bidijkstra") == 0)
+    {
+        return solverBidirectionalDijkstra;
+    }
+    if (strcmp(name, "biastar") == 0)
+    {
+        return solverBidirectionalAStar;
+    }
+    if (strcmp(name, "pbfs") == 0)
+    {
+        return solverParallelBreadthFirstSearch;
+    }
+    if (strcmp(name, "bitbfs") == 0)
+    {
+        return solverBitboardBreadthFirstSearch;
+    }
+    if (strcmp(name, "delta") == 0)
+    {
+        return solverDeltaStepping;
+    }
+    if (strcmp(name, "hpa") == 0)
+    {
+        return solverHierarchical;
+    }
+    if (strcmp(name, "dstar") == 0)
+    {
+        return solverReplanning;
+    }
+    if (strcmp(name, "alt") == 0)
+    {
+        return solverLandmarkAStar;
+    }
+    if (strcmp(name, "flow") == 0)
+    {
+        return solverFlowField;
+    }
+    return -1;
+}
+
+int ParseMaze(const char *name)
+{
+    if (strcmp(name, "prim") == 0)
+    {
+        return mazePrim;
+    }
+    if (strcmp(name, "dfs") == 0)
+    {
+        return mazeDfs;
+    }
+    if (strcmp(name, "sidewinder") == 0)
+    {
+        return mazeSidewinder;
+    }
+    return -1;
+}
+
+int ParseEngine(const char *name)
+{
+    if (strcmp(name, "auto") == 0)
+    {
+        return bitboardAuto;
+    }
+    if (strcmp(name, "scalar") == 0)
+    {
+        return bitboardScalar;
+    }
+    if (strcmp(name, "avx2") == 0)
+    {
+        return bitboardAvx2;
+    }
+    return -1;
+}
+
+int ParseQueue(const char *name)
+{
+    if (strcmp(name, "auto") == 0)
+    {
+        return queueAuto;
+    }
+    if (strcmp(name, "heap") == 0)
+    {
+        return queueBinaryHeap;
+    }
+    if (strcmp(name, "bucket") == 0)
+    {
+        return queueBucket;
+    }
+    return -1;
+}
+
+bool ParseOptions(int argc, char *argv[], SolveOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            return false;
+        }
+        if (value == NULL)
+        {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--map") == 0)
+        {
+            options.mapFile = value;
+        }
+        else if (strcmp(arg, "--save") == 0)
+        {
+            options.saveFile = value;
+        }
+        else if (strcmp(arg, "--queries") == 0)
+        {
+            options.queryFile = value;
+        }
+        else if (strcmp(arg, "--solver") == 0)
+        {
+            options.solver = ParseSolver(value);
+        }
+        else if (strcmp(arg, "--maze") == 0)
+        {
+            int maze = ParseMaze(value);
+            if (maze == -1)
+            {
+                fprintf(stderr, "Unknown maze %s\n", value);
+                return false;
+            }
+            options.generateMaze = true;
+            options.maze = (MazeType)maze;
+        }
+        else if (strcmp(arg, "--queue") == 0)
+        {
+            int queue = ParseQueue(value);
+            if (queue == -1)
+            {
+                fprintf(stderr, "Unknown queue %s\n", value);
+                return false;
+            }
+            options.queue = (QueueBackend)queue;
+        }
+        else if (strcmp(arg, "--size") == 0)
+        {
+            if (sscanf(value, "%dx%d", &options.rows, &options.cols) != 2)
+            {
+                if (sscanf(value, "%d", &options.rows) != 1)
+                {
+                    fprintf(stderr, "Invalid size %s\n", value);
+                    return false;
+                }
+                options.cols = options.rows;
+            }
+        }
+        else if (strcmp(arg, "--start") == 0)
+        {
+            sscanf(value, "%d,%d", &options.startX, &options.startY);
+        }
+        else if (strcmp(arg, "--end") == 0)
+        {
+            sscanf(value, "%d,%d", &options.endX, &options.endY);
+        }
+        else if (strcmp(arg, "--seed") == 0)
+        {
+            options.seed = strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--threads") == 0)
+        {
+            options.threads = atoi(value);
+        }
+        else if (strcmp(arg, "--delta") == 0)
+        {
+            options.delta = atoi(value);
+        }
+        else if (strcmp(arg, "--landmarks") == 0)
+        {
+            options.landmarks = atoi(value);
+        }
+        else if (strcmp(arg, "--cache") == 0)
+        {
+            options.cacheSize = atoi(value);
+        }
+        else if (strcmp(arg, "--engine") == 0)
+        {
+            int engine = ParseEngine(value);
+            if (engine == -1)
+            {
+                fprintf(stderr, "Unknown engine %s\n", value);
+                return false;
+            }
+            options.engine = (BitboardEngine)engine;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+    }
+
+    if (options.solver == -1)
+    {
+        fprintf(stderr, "Unknown solver\n");
+        return false;
+    }
+    if (options.mapFile == NULL && !options.generateMaze)
+    {
+        fprintf(stderr, "Either --map or --maze is required\n");
+        return false;
+    }
+    if (options.rows < 2 || options.cols < 2)
+    {
+        fprintf(stderr, "Grid must be at least 2x2\n");
+        return false;
+    }
+    return true;
+}
+
+// Converts X,Y to a grid index, falling back to the first or last open cell
+int ResolveCell(const Grid &grid, int x, int y, int fileIndex, bool first)
+{
+    if (x >= 0 && y >= 0 && x < grid.cols && y < grid.rows)
+    {
+        return grid.Index(x, y);
+    }
+    if (fileIndex != -1)
+    {
+        return fileIndex;
+    }
+
+    for (int i = 0; i < grid.rows * grid.cols; i++)
+    {
+        int cell = first ? i : grid.rows * grid.cols - 1 - i;
+        int index = grid.Index(cell % grid.cols, cell / grid.cols);
+
+        if (!grid.IsWall(index))
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Search run by a solver, -1 for solvers that are not a plain search
+int SolverSearchType(int solver)
+{
+    switch (solver)
+    {
+    case solverDepthFirstSearch:
+        return searchDepthFirst;
+    case solverBreadthFirstSearch:
+        return searchBreadthFirst;
+    case solverDijkstra:
+        return searchDijkstra;
+    case solverAStar:
+        return searchAStar;
+    case solverJumpPoint:
+        return searchJumpPoint;
+    case solverJumpPointPlus:
+        return searchJumpPointPlus;
+    case solverBidirectionalBreadthFirstSearch:
+        return searchBidirectionalBreadthFirst;
+    case solverBidirectionalDijkstra:
+        return searchBidirectionalDijkstra;
+    case solverBidirectionalAStar:
+        return searchBidirectionalAStar;
+    }
+    return -1;
+}
+
+// Reads one query per line, blank lines and lines starting with '#' are skipped
+bool ReadQueryFile(const char *fileName, const Grid &grid, std::vector<BatchQuery> &queries)
+{
+    FILE *file = fopen(fileName, "r");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Could not read queries %s\n", fileName);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool valid = true;
+
+    while (valid && fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        const char *text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0')
+        {
+            continue;
+        }
+
+        int startX, startY, endX, endY;
+        if (sscanf(text, "%d,%d %d,%d", &startX, &startY, &endX, &endY) != 4 || startX < 0 || startY < 0 || endX < 0 || endY < 0 ||
+            startX >= grid.cols || startY >= grid.rows || endX >= grid.cols || endY >= grid.rows)
+        {
+            fprintf(stderr, "Bad query on line %d of %s\n", lineNumber, fileName);
+            valid = false;
+        }
+        else
+        {
+            queries.push_back({grid.Index(startX, startY), grid.Index(endX, endY)});
+        }
+    }
+    fclose(file);
+    return valid;
+}
+
+// Solves a query file as one batch and prints a line per query in file order
+int SolveQueryFile(const SolveOptions &options, const Grid &grid)
+{
+    int type = SolverSearchType(options.solver);
+
+    if (type == -1 && options.solver != solverHierarchical)
+    {
+        fprintf(stderr, "--queries needs dfs, bfs, dijkstra, astar, jps, jps+, bibfs, bidijkstra, biastar or hpa\n");
+        return 1;
+    }
+
+    std::vector<BatchQuery> queries;
+    if (!ReadQueryFile(options.queryFile, grid, queries))
+    {
+        return 1;
+    }
+
+    ThreadPool pool(options.threads);
+    PathCache cache(std::max(options.cacheSize, 0));
+    auto solveStart = std::chrono::steady_clock::now();
+    std::vector<SearchResult> results;
+
+    if (options.solver == solverHierarchical)
+    {
+        // The abstract graph is built once for the whole batch, only the queries count as solve time
+        HierarchicalGraph hierarchy;
+        hierarchy.Build(grid, &pool);
+        printf("build time: %.3f ms on %d threads\n", MillisecondsSince(solveStart), pool.Size());
+
+        solveStart = std::chrono::steady_clock::now();
+        results = SolveBatch(pool, hierarchy, grid, queries, options.cacheSize > 0 ? &cache : NULL);
+    }
+    else
+    {
+        results = SolveBatch(pool, grid, queries, (SearchType)type, options.queue, options.cacheSize > 0 ? &cache : NULL);
+    }
+    double solveTime = MillisecondsSince(solveStart);
+
+    int found = 0;
+    long long expansions = 0;
+
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        const SearchResult &result = results[i];
+
+        printf("query %zu: %d,%d -> %d,%d found %s length %d cost %d expansions %lld\n", i, grid.X(queries[i].startIndex),
+               grid.Y(queries[i].startIndex), grid.X(queries[i].endIndex), grid.Y(queries[i].endIndex), result.found ? "yes" : "no",
+               result.pathLength, result.pathCost, result.expansions);
+        found += result.found ? 1 : 0;
+        expansions += result.expansions;
+    }
+
+    printf("queries: %zu\n", queries.size());
+    printf("found: %d\n", found);
+    printf("threads: %d\n", pool.Size());
+    if (options.cacheSize > 0)
+    {
+        printf("cache: %lld hits, %lld misses\n", cache.hits, cache.misses);
+    }
+    printf("expansions: %lld\n", expansions);
+    printf("time: %.3f ms\n", solveTime);
+    printf("throughput: %.1f queries/s\n", solveTime > 0 ? queries.size() * 1000.0 / solveTime : 0.0);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    SolveOptions options = {NULL, NULL, NULL, solverNone, false, mazePrim, queueAuto, 50, 50, (unsigned int)time(NULL), -1, -1, -1, -1, 0, bitboardAuto, 0, LANDMARK_DEFAULT_COUNT, 0};
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    SetAlgorithmSeed(options.seed);
+
+    Grid grid = {0};
+    int fileStart = -1;
+    int fileEnd = -1;
+
+    if (options.mapFile != NULL)
+    {
+        if (!ReadGridFile(options.mapFile, grid, fileStart, fileEnd))
+        {
+            fprintf(stderr, "Could not read grid %s\n", options.mapFile);
+            return 1;
+        }
+    }
+    else if (!grid.Resize(options.rows, options.cols))
+    {
+        fprintf(stderr, "Grid must be at most %d cells\n", GRID_MAX_CELLS);
+        return 1;
+    }
+
+    printf("grid: %dx%d\n", grid.rows, grid.cols);
+
+    if (options.generateMaze)
+    {
+        auto mazeStart = std::chrono::steady_clock::now();
+
+        grid.Fill(true);
+        GenerateMaze(options.maze, grid);
+        printf("maze time: %.3f ms\n", MillisecondsSince(mazeStart));
+    }
+
+    int startIndex = ResolveCell(grid, options.startX, options.startY, fileStart, true);
+    int endIndex = ResolveCell(grid, options.endX, options.endY, fileEnd, false);
+
+    if (options.saveFile != NULL && !WriteGridFile(options.saveFile, grid, startIndex, endIndex))
+    {
+        fprintf(stderr, "Could not write grid %s\n", options.saveFile);
+        return 1;
+    }
+
+    if (options.solver == solverNone)
+    {
+        return 0;
+    }
+    if (options.queryFile != NULL)
+    {
+        return SolveQueryFile(options, grid);
+    }
+    if (startIndex == -1 || endIndex == -1 || grid.IsWall(startIndex) || grid.IsWall(endIndex))
+    {
+        fprintf(stderr, "Start and end must be open cells\n");
+        return 1;
+    }
+
+    SearchResult result = {false, 0, 0, 0};
+    auto solveStart = std::chrono::steady_clock::now();
+
+    switch (options.solver)
+    {
+    case solverDepthFirstSearch:
+        result = RunSearch(searchDepthFirst, grid, startIndex, endIndex);
+        break;
+    case solverBreadthFirstSearch:
+        result = RunSearch(searchBreadthFirst, grid, startIndex, endIndex);
+        break;
+    case solverDijkstra:
+        result = RunSearch(searchDijkstra, grid, startIndex, endIndex, options.queue);
+        break;
+    case solverAStar:
+        result = RunSearch(searchAStar, grid, startIndex, endIndex, options.queue);
+        break;
+    case solverJumpPoint:
+        result = RunSearch(searchJumpPoint, grid, startIndex, endIndex, options.queue);
+        break;
+    case solverJumpPointPlus:
+    {
+        // The jump table is built once per map like the HPA* graph, only the query counts as solve time
+        JumpTable table;
+        table.Build(grid);
+        printf("build time: %.3f ms\n", MillisecondsSince(solveStart));
+
+        solveStart = std::chrono::steady_clock::now();
+        result = RunJumpPointPlusSearch(table, grid, startIndex, endIndex);
+        break;
+    }
+    case solverBidirectionalBreadthFirstSearch:
+        result = RunSearch(searchBidirectionalBreadthFirst, grid, startIndex, endIndex);
+        break;
+    case solverBidirectionalDijkstra:
+        result = RunSearch(searchBidirectionalDijkstra, grid, startIndex, endIndex, options.queue);
+        break;
+    case solverBidirectionalAStar:
+        result = RunSearch(searchBidirectionalAStar, grid, startIndex, endIndex, options.queue);
+        break;
+    case solverParallelBreadthFirstSearch:
+    {
+        ThreadPool pool(options.threads);
+        result = ParallelBreadthFirstSearch(pool, grid, startIndex, endIndex);
+        break;
+    }
+    case solverBitboardBreadthFirstSearch:
+        printf("engine: %s\n", BitboardEngineName(ResolveBitboardEngine(options.engine)));
+        result = BitboardBreadthFirstSearch(grid, startIndex, endIndex, options.engine);
+        break;
+    case solverDeltaStepping:
+    {
+        ThreadPool pool(options.threads);
+        result = DeltaSteppingSearch(pool, grid, startIndex, endIndex, options.delta);
+        break;
+    }
+    case solverHierarchical:
+    {
+        // The abstract graph is built once per map, only the query counts as solve time
+        ThreadPool pool(options.threads);
+        HierarchicalGraph hierarchy;
+        hierarchy.Build(grid, &pool);
+        printf("build time: %.3f ms on %d threads\n", MillisecondsSince(solveStart), pool.Size());
+
+        solveStart = std::chrono::steady_clock::now();
+        result = hierarchy.Search(grid, startIndex, endIndex);
+        break;
+    }
+    case solverReplanning:
+    {
+        DStarLite planner;
+        result = planner.Plan(grid, startIndex, endIndex);
+        break;
+    }
+    case solverLandmarkAStar:
+    {
+        // Tables live next to the map so later queries on it skip the preprocessing, which is not solve time
+        const char *gridFile = options.mapFile != NULL ? options.mapFile : options.saveFile;
+        std::string tableFile = gridFile != NULL ? std::string(gridFile) + ".alt" : std::string();
+        LandmarkTable table;
+
+        bool loaded = !tableFile.empty() && table.Load(tableFile.c_str(), grid) && table.requested == options.landmarks;
+        if (!loaded)
+        {
+            table.Build(grid, options.landmarks);
+            if (!tableFile.empty() && !table.Save(tableFile.c_str()))
+            {
+                fprintf(stderr, "Could not write landmarks %s\n", tableFile.c_str());
+            }
+        }
+        printf("landmarks: %d %s in %.3f ms\n", table.count, loaded ? "loaded" : "built", MillisecondsSince(solveStart));
+
+        solveStart = std::chrono::steady_clock::now();
+        result = RunLandmarkSearch(table, grid, startIndex, endIndex, options.queue);
+        break;
+    }
+    case solverFlowField:
+    {
+        // The field serves every start heading to this end, only following it from the start counts as solve time
+        FlowField field;
+        long long reached = field.Build(grid, endIndex);
+        printf("field: %lld cells reach the end in %.3f ms\n", reached, MillisecondsSince(solveStart));
+
+        solveStart = std::chrono::steady_clock::now();
+        result = field.Follow(grid, startIndex);
+        break;
+    }
+    }
+
+    double solveTime = MillisecondsSince(solveStart);
+
+    printf("start: %d,%d\n", grid.X(startIndex), grid.Y(startIndex));
+    printf("end: %d,%d\n", grid.X(endIndex), grid.Y(endIndex));
+    printf("found: %s\n", result.found ? "yes" : "no");
+    printf("path length: %d\n", result.pathLength);
+    printf("path cost: %d\n", result.pathCost);
+    printf("expansions: %lld\n", result.expansions);
+    printf("time: %.3f ms\n", solveTime);
+
+    return result.found ? 0 : 2;
+}
@@ -1,378 +1,835 @@
-#include "raylib.h"
-
-#include "pv_gui.h"
-#include "pv_algorithms.h"
-
-#include <thread>
-#include <atomic>
-
-// Thread synchronization
-static std::atomic<bool> done(false);
-
-struct ControlState
-{
-    int pathfindingButtonIndex;
-    int cellButtonIndex;
-
-    int startCellIndex;
-    int endCellIndex;
-
-    Color cellDrawColor;
-};
-
-int main()
-{
-    // Initialization
-    const int gridRows = 50;
-    const int gridCols = 50;
-    float screenWidth = 1280;
-    float screenHeight = 720;
-
-    ControlState state = {0, 0, 1250, 1299, RAYWHITE};
-
-    std::thread thread;
-
-    // ID for gui elements
-    int id = 0;
-
-    InitWindow(screenWidth, screenHeight, "Pathfinding Visualizer");
-    SetWindowMinSize(screenWidth, screenHeight);
-    SetWindowState(FLAG_VSYNC_HINT | FLAG_WINDOW_ALWAYS_RUN | FLAG_WINDOW_RESIZABLE);
-
-    // Region for all of the buttons
-    Rectangle controlRegion = {0, 0, screenWidth / 5, screenHeight};
-    Rectangle gridRegion = {controlRegion.width, 0, screenWidth - controlRegion.width, screenHeight};
-    gridRegion = CenterAndSizeGuiElement(gridRegion, 1, 0, squareFill);
-
-    // Initialize button regions
-    Rectangle buttonRegions[4];
-    int buttonRegionArraySize = 4;
-
-    for (int i = 0; i < buttonRegionArraySize; i++)
-    {
-        buttonRegions[i] = CenterAndSizeGuiElement(controlRegion, buttonRegionArraySize, i, verticalFill);
-    }
-
-    // Initialize pathfinding buttons
-    enum PathfindingTypes
-    {
-        depthFirstSearch,
-        breadthFirstSearch,
-        dijkstra,
-        aStar
-    };
-    const char *pathfindingButtonText[] = {"Depth First Search", "Breadth First Search", "Dijkstra's", "A*"};
-    int pathfindingArraySize = 4;
-    Button pathfindingButtons[pathfindingArraySize];
-
-    for (int i = 0; i < pathfindingArraySize; i++)
-    {
-        pathfindingButtons[i] = {CenterAndSizeGuiElement(buttonRegions[0], pathfindingArraySize, i, verticalSpaced), pathfindingButtonText[i], buttonTypeText, LIGHTGRAY, id++};
-    }
-
-    // Initialize maze buttons
-    enum MazeTypes
-    {
-        prim,
-        dfs,
-        sidewinder
-    };
-    const char *mazeButtonText[] = {"Randomized Prim's Maze", "Randomized DFS Maze", "Sidewinder Maze"};
-    int mazeArraySize = 3;
-    Button mazeButtons[mazeArraySize];
-
-    for (int i = 0; i < mazeArraySize; i++)
-    {
-        mazeButtons[i] = {CenterAndSizeGuiElement(buttonRegions[1], mazeArraySize, i, verticalSpaced), mazeButtonText[i], buttonTypeText, LIGHTGRAY, id++};
-    }
-
-    // Initialize cell buttons
-    Color cellButtonColors[] = {RAYWHITE, BEIGE, GREEN, RED, LIGHTGRAY};
-    const char *cellButtonText[] = {"Empty", "Wall", "Start", "End", "Weight"};
-    int cellArraySize = 5;
-    Button cellButtons[cellArraySize];
-
-    for (int i = 0; i < cellArraySize; i++)
-    {
-        cellButtons[i] = {CenterAndSizeGuiElement(buttonRegions[2], cellArraySize, i, gridSpaced), cellButtonText[i], buttonTypeImage, cellButtonColors[i], id++};
-    }
-
-    // Initialize control buttons
-    enum ControlTypes
-    {
-        visualize,
-        clear
-    };
-    const char *controlButtonText[] = {"Visualize", "Clear"};
-    Color controlButtonColors[] = {PURPLE, LIGHTGRAY};
-    int controlArraySize = 2;
-    Button controlButtons[controlArraySize];
-
-    for (int i = 0; i < controlArraySize; i++)
-    {
-        controlButtons[i] = {CenterAndSizeGuiElement(buttonRegions[3], controlArraySize, i, verticalSpaced), controlButtonText[i], buttonTypeText, controlButtonColors[i], id++};
-    }
-
-    // Initialize grid
-    const int gridSize = gridRows * gridCols;
-    Cell cells[gridSize];
-
-    for (int i = 0; i < gridSize; i++)
-    {
-        cells[i] = {CenterAndSizeGuiElement(gridRegion, gridSize, i, gridFill), RAYWHITE, false, id++};
-    }
-
-    // Render loop
-    while (!WindowShouldClose())
-    {
-        // Update GUI as window size changes
-        if (IsWindowResized())
-        {
-            screenHeight = GetScreenHeight();
-            screenWidth = GetScreenWidth();
-
-            // Update control region
-            controlRegion.height = screenHeight;
-            controlRegion.width = screenWidth / 5;
-
-            // Update grid region
-            gridRegion.x = controlRegion.width;
-            gridRegion.height = screenHeight;
-            gridRegion.width = screenWidth - controlRegion.width;
-            gridRegion = CenterAndSizeGuiElement(gridRegion, 1, 0, squareFill);
-
-            // Update button regions
-            for (int i = 0; i < buttonRegionArraySize; i++)
-            {
-                buttonRegions[i] = CenterAndSizeGuiElement(controlRegion, buttonRegionArraySize, i, verticalFill);
-            }
-
-            // Update pathfinding buttons
-            for (int i = 0; i < pathfindingArraySize; i++)
-            {
-                pathfindingButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[0], pathfindingArraySize, i, verticalSpaced);
-            }
-
-            // Update maze buttons
-            for (int i = 0; i < mazeArraySize; i++)
-            {
-                mazeButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[1], mazeArraySize, i, verticalSpaced);
-            }
-
-            // Update cell buttons
-            for (int i = 0; i < cellArraySize; i++)
-            {
-                cellButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[2], cellArraySize, i, gridSpaced);
-            }
-
-            // Update control buttons
-            for (int i = 0; i < controlArraySize; i++)
-            {
-                controlButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[3], controlArraySize, i, verticalSpaced);
-            }
-
-            // Update grid
-            for (int i = 0; i < gridSize; i++)
-            {
-                cells[i].bounds = CenterAndSizeGuiElement(gridRegion, gridSize, i, gridFill);
-            }
-        }
-
-        // Thread check
-        if (std::atomic_load(&done))
-        {
-            // Synchronize the thread
-            thread.join();
-            GuiUnlock();
-            std::atomic_store(&done, false);
-        }
-
-        // Draw code
-        BeginDrawing();
-        ClearBackground(DARKGRAY);
-
-        // Draw grid
-        for (int i = 0; i < gridSize; i++)
-        {
-            // Check if the cell has been clicked
-            if (cells[i].Draw())
-            {
-                // Placing a start cell
-                if (state.cellDrawColor == GREEN)
-                {
-                    // Start and end should not be the same cell
-                    if (i != state.endCellIndex)
-                    {
-                        state.startCellIndex = i;
-                    }
-                }
-                // Placing an end cell
-                else if (state.cellDrawColor == RED)
-                {
-                    if (i != state.startCellIndex)
-                    {
-                        state.endCellIndex = i;
-                    }
-                }
-                // Update the cell to the current draw color
-                else
-                {
-                    // Special case for weighted nodes that will get tinted
-                    if (state.cellDrawColor == LIGHTGRAY)
-                    {
-                        cells[i].color = RAYWHITE;
-                        cells[i].weighted = true;
-                    }
-                    else
-                    {
-                        cells[i].color = state.cellDrawColor;
-                        cells[i].weighted = false;
-                    }
-                }
-            }
-
-            // Draw start and end cells
-            if (i == state.startCellIndex)
-            {
-                DrawRectangleRec(cells[i].bounds, GREEN);
-                DrawRectangleLinesEx(cells[i].bounds, 1, BLACK);
-            }
-            else if (i == state.endCellIndex)
-            {
-                DrawRectangleRec(cells[i].bounds, RED);
-                DrawRectangleLinesEx(cells[i].bounds, 1, BLACK);
-            }
-        }
-
-        // Draw pathfinding buttons
-        for (int i = 0; i < pathfindingArraySize; i++)
-        {
-            if (pathfindingButtons[i].Draw())
-            {
-                state.pathfindingButtonIndex = i;
-            }
-            // Highlight selected button
-            if (state.pathfindingButtonIndex == i)
-            {
-                DrawRectangleLinesEx(pathfindingButtons[i].bounds, 2, BLUE);
-            }
-        }
-
-        // Draw maze buttons
-        for (int i = 0; i < mazeArraySize; i++)
-        {
-            if (mazeButtons[i].Draw())
-            {
-                // Fill the grid with walls
-                for (int i = 0; i < gridSize; i++)
-                {
-                    cells[i].color = BEIGE;
-                    cells[i].weighted = false;
-                }
-
-                switch (i)
-                {
-                case prim:
-                {
-                    GuiLock();
-                    thread = std::thread(RandomizedPrimsMaze, std::ref(cells), gridRows, gridCols, std::ref(done));
-                    break;
-                }
-                case dfs:
-                {
-                    GuiLock();
-                    thread = std::thread(RandomizedDFSMaze, std::ref(cells), gridRows, gridCols, std::ref(done));
-                    break;
-                }
-                case sidewinder:
-                {
-                    GuiLock();
-                    thread = std::thread(SidewinderMaze, std::ref(cells), gridRows, gridCols, std::ref(done));
-                    break;
-                }
-                }
-            }
-        }
-
-        // Draw control buttons
-        for (int i = 0; i < controlArraySize; i++)
-        {
-            if (controlButtons[i].Draw())
-            {
-                switch (i)
-                {
-                case visualize:
-                {
-                    // Reset grid
-                    for (int i = 0; i < gridSize; i++)
-                    {
-                        if (cells[i].color != BEIGE)
-                        {
-                            cells[i].color = RAYWHITE;
-                        }
-                    }
-                    switch (state.pathfindingButtonIndex)
-                    {
-                    case depthFirstSearch:
-                    {
-                        GuiLock();
-                        thread = std::thread(DepthFirstSearch, std::ref(cells), gridRows, gridCols, state.startCellIndex, state.endCellIndex, std::ref(done));
-                        break;
-                    }
-                    case breadthFirstSearch:
-                    {
-                        GuiLock();
-                        thread = std::thread(BreadthFirstSearch, std::ref(cells), gridRows, gridCols, state.startCellIndex, state.endCellIndex, std::ref(done));
-                        break;
-                    }
-                    case dijkstra:
-                    {
-                        GuiLock();
-                        thread = std::thread(Dijkstra, std::ref(cells), gridRows, gridCols, state.startCellIndex, state.endCellIndex, std::ref(done));
-                        break;
-                    }
-                    case aStar:
-                    {
-                        GuiLock();
-                        thread = std::thread(AStar, std::ref(cells), gridRows, gridCols, state.startCellIndex, state.endCellIndex, std::ref(done));
-                        break;
-                    }
-                    }
-                    break;
-                }
-                case clear:
-                {
-                    for (int i = 0; i < gridSize; i++)
-                    {
-                        cells[i].color = RAYWHITE;
-                        cells[i].weighted = false;
-                    }
-                    break;
-                }
-                }
-            }
-        }
-
-        // Draw cell buttons
-        for (int i = 0; i < cellArraySize; i++)
-        {
-            if (cellButtons[i].Draw())
-            {
-                state.cellButtonIndex = i;
-                state.cellDrawColor = cellButtons[i].color;
-            }
-            if (state.cellButtonIndex == i)
-            {
-                DrawRectangleLinesEx(cellButtons[i].bounds, 2, BLUE);
-            }
-        }
-
-        DrawFPS(0, 0);
-        EndDrawing();
-    }
-
-    // De-Initialization
-    CloseWindow();
-
-    return 0;
+#include "raylib.h"
+
+#include "pv_gui.h"
+#include "pv_render.h"
+#include "pv_algorithms.h"
+#include "pv_hierarchy.h"
+#include "pv_dstar.h"
+#include "pv_cache.h"
+#include "pv_flowfield.h"
+
+#include <atomic>
+#include <climits>
+#include <math.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Events drawn per frame double every 1/20 of the speed slider, a full slider draws everything available
+#define SPEED_DOUBLINGS 20
+
+// Events the algorithm thread can run ahead of the renderer
+#define EVENT_RING_CAPACITY (1 << 16)
+
+// Events copied out of the ring at a time
+#define EVENT_BATCH_SIZE 1024
+
+// Steps run between checks for cancellation
+#define WORKER_STEP_CHUNK 4096
+
+// Largest brush radius reachable with the mouse wheel
+#define MAX_BRUSH_RADIUS 32
+
+struct ControlState
+{
+    int pathfindingButtonIndex;
+    int cellButtonIndex;
+
+    // Runs BFS, Dijkstra and A* from both ends
+    bool bidirectional;
+
+    int startCellIndex;
+    int endCellIndex;
+};
+
+// Solvers that keep their work between runs, told about every cell edited since
+struct IncrementalSolvers
+{
+    HierarchicalGraph hierarchy;
+    DStarLite planner;
+
+    // Rebuilt by the next JPS+ search after an edit, it checks the grid generation itself
+    JumpTable jumpTable;
+
+    void CellChanged(const Grid &grid, int index)
+    {
+        hierarchy.MarkDirty(grid.X(index), grid.Y(index));
+        planner.CellChanged(index);
+    }
+
+    // Mazes and clearing change every cell
+    void GridChanged()
+    {
+        hierarchy.MarkAllDirty();
+        planner.Invalidate();
+    }
+};
+
+// Grid sizes cycled through by the grid size button
+static const int gridSizePresets[] = {10, 25, 50, 100, 200, 400};
+static const int gridSizePresetCount = 6;
+
+// Start and end cells default to opposite ends of the middle row
+void ResetStartAndEnd(ControlState &state, const Grid &grid)
+{
+    state.startCellIndex = grid.Index(0, grid.rows / 2);
+    state.endCellIndex = grid.Index(grid.cols - 1, grid.rows / 2);
+}
+
+// Search actually run for the selected button, the other searches have no bidirectional variant
+SearchType SelectedSearch(SearchType type, bool bidirectional)
+{
+    if (bidirectional)
+    {
+        switch (type)
+        {
+        case searchBreadthFirst:
+            return searchBidirectionalBreadthFirst;
+        case searchDijkstra:
+            return searchBidirectionalDijkstra;
+        case searchAStar:
+            return searchBidirectionalAStar;
+        default:
+            break;
+        }
+    }
+    return type;
+}
+
+void UpdateDirectionText(char *text, size_t size, bool bidirectional)
+{
+    snprintf(text, size, bidirectional ? "Search: both ends" : "Search: from start");
+}
+
+// True when the brush centred on x, y paints the cell dx, dy away, a disk of the radius cut to the grid
+bool BrushCovers(const Grid &grid, int x, int y, int dx, int dy, int radius)
+{
+    int cx = x + dx;
+    int cy = y + dy;
+
+    return dx * dx + dy * dy <= radius * radius && cx >= 0 && cy >= 0 && cx < grid.cols && cy < grid.rows;
+}
+
+// Paints every cell within radius of x, y, the incremental solvers only repair the painted cells on their next run
+void PaintBrush(Grid &grid, GridRenderer &renderer, IncrementalSolvers &solvers, int x, int y, int radius, bool wall, bool weighted)
+{
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            int cx = x + dx;
+            int cy = y + dy;
+
+            if (!BrushCovers(grid, x, y, dx, dy, radius))
+            {
+                continue;
+            }
+
+            int index = grid.Index(cx, cy);
+            grid.SetWall(index, wall);
+            grid.SetWeighted(index, weighted);
+            grid.states[index] = cellUnvisited;
+            renderer.MarkDirty(cx, cy);
+            solvers.CellChanged(grid, index);
+        }
+    }
+}
+
+// Outlines the cells PaintBrush would paint, every side of a covered cell that borders an uncovered one
+void DrawBrushOutline(const GridLayout &layout, const Grid &grid, int x, int y, int radius)
+{
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            if (!BrushCovers(grid, x, y, dx, dy, radius))
+            {
+                continue;
+            }
+
+            Rectangle cell = layout.CellBounds(x + dx, y + dy);
+            float left = cell.x;
+            float top = cell.y;
+            float right = cell.x + cell.width;
+            float bottom = cell.y + cell.height;
+
+            if (!BrushCovers(grid, x, y, dx, dy - 1, radius))
+            {
+                DrawLineEx({left, top}, {right, top}, 2, YELLOW);
+            }
+            if (!BrushCovers(grid, x, y, dx - 1, dy, radius))
+            {
+                DrawLineEx({left, top}, {left, bottom}, 2, YELLOW);
+            }
+            if (!BrushCovers(grid, x, y, dx, dy + 1, radius))
+            {
+                DrawLineEx({left, bottom}, {right, bottom}, 2, YELLOW);
+            }
+            if (!BrushCovers(grid, x, y, dx + 1, dy, radius))
+            {
+                DrawLineEx({right, top}, {right, bottom}, 2, YELLOW);
+            }
+        }
+    }
+}
+
+// Paints from the previous mouse sample to the current one with Bresenham's line, so fast drags leave no gaps
+void PaintStroke(Grid &grid, GridRenderer &renderer, IncrementalSolvers &solvers, int x0, int y0, int x1, int y1, int radius, bool wall, bool weighted)
+{
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int stepX = x0 < x1 ? 1 : -1;
+    int stepY = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+
+    while (true)
+    {
+        PaintBrush(grid, renderer, solvers, x0, y0, radius, wall, weighted);
+
+        if (x0 == x1 && y0 == y1)
+        {
+            break;
+        }
+
+        int error2 = 2 * error;
+        if (error2 >= dy)
+        {
+            error += dy;
+            x0 += stepX;
+        }
+        if (error2 <= dx)
+        {
+            error += dx;
+            y0 += stepY;
+        }
+    }
+}
+
+// HPA* answers from its cached abstract graph without a stepper, only the refined path is drawn
+void ShowHierarchicalPath(HierarchicalGraph &hierarchy, Grid &grid, GridRenderer &renderer, int startIndex, int endIndex)
+{
+    std::vector<int> path;
+
+    hierarchy.Update(grid);
+    hierarchy.Search(grid, startIndex, endIndex, &path);
+
+    for (int index : path)
+    {
+        grid.states[index] = cellPath;
+        renderer.MarkDirty(grid.X(index), grid.Y(index));
+    }
+}
+
+// D* Lite replans from its previous run, the cells it had to expand again are drawn as visited under the path
+void ShowReplannedPath(DStarLite &planner, Grid &grid, GridRenderer &renderer, int startIndex, int endIndex)
+{
+    std::vector<int> path;
+    std::vector<int> expanded;
+
+    planner.Plan(grid, startIndex, endIndex, &path, &expanded);
+
+    for (int index : expanded)
+    {
+        grid.states[index] = cellVisited;
+        renderer.MarkDirty(grid.X(index), grid.Y(index));
+    }
+    for (int index : path)
+    {
+        grid.states[index] = cellPath;
+        renderer.MarkDirty(grid.X(index), grid.Y(index));
+    }
+}
+
+// Builds the field toward the end and shows it over the grid, the path is what an agent on the start would follow
+void ShowFlowField(FlowOverlay &overlay, Grid &grid, GridRenderer &renderer, int startIndex, int endIndex)
+{
+    FlowField field;
+    std::vector<int> path;
+
+    field.Build(grid, endIndex);
+    field.Follow(grid, startIndex, &path);
+    overlay.Show(grid, field);
+
+    for (int index : path)
+    {
+        grid.states[index] = cellPath;
+        renderer.MarkDirty(grid.X(index), grid.Y(index));
+    }
+}
+
+// Repeated searches on an unchanged grid are drawn straight from the path cache
+void ShowCachedPath(const std::vector<int> &path, Grid &grid, GridRenderer &renderer)
+{
+    for (int index : path)
+    {
+        grid.states[index] = cellPath;
+        renderer.MarkDirty(grid.X(index), grid.Y(index));
+    }
+}
+
+// The window title shows how often Visualize was answered from the path cache
+void UpdateCacheTitle(const PathCache &cache)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "Pathfinding Visualizer - path cache: %lld hits, %lld misses", cache.hits, cache.misses);
+    SetWindowTitle(title);
+}
+
+// Runs on the algorithm thread, the stepper only talks to the renderer through the event ring
+void RunStepper(Stepper *stepper, EventRing *events, std::atomic<bool> *done)
+{
+    while (!events->IsCancelled() && !stepper->Step(WORKER_STEP_CHUNK))
+    {
+    }
+    done->store(true, std::memory_order_release);
+}
+
+void StartWorker(Stepper *stepper, EventRing &events, std::atomic<bool> &done, std::thread &worker)
+{
+    done.store(false);
+    worker = std::thread(RunStepper, stepper, &events, &done);
+}
+
+// Applies up to maxEvents queued events to the grid
+void DrainEvents(EventRing &events, Grid &grid, GridRenderer &renderer, long long maxEvents)
+{
+    GridEvent batch[EVENT_BATCH_SIZE];
+
+    while (maxEvents > 0)
+    {
+        size_t count = events.Pop(batch, maxEvents < EVENT_BATCH_SIZE ? maxEvents : EVENT_BATCH_SIZE);
+        if (count == 0)
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            int index = GridEventIndex(batch[i]);
+
+            ApplyGridEvent(grid, batch[i]);
+            renderer.MarkDirty(grid.X(index), grid.Y(index));
+        }
+        maxEvents -= count;
+    }
+}
+
+// Number of events drawn per frame for a speed slider value
+long long EventsPerFrame(float speed)
+{
+    if (speed >= 1)
+    {
+        return LLONG_MAX;
+    }
+    return fmax(1, pow(2, speed * SPEED_DOUBLINGS));
+}
+
+void UpdateSpeedText(char *text, int size, float speed)
+{
+    if (speed >= 1)
+    {
+        snprintf(text, size, "Speed: instant");
+    }
+    else
+    {
+        snprintf(text, size, "Speed: %lld/frame", EventsPerFrame(speed));
+    }
+}
+
+// Usage: PathfindingVisualizer [rows] [cols]
+bool ParseGridSize(int argc, char *argv[], int &rows, int &cols)
+{
+    if (argc > 1)
+    {
+        rows = atoi(argv[1]);
+        cols = argc > 2 ? atoi(argv[2]) : rows;
+    }
+
+    if (rows < 2 || cols < 2 || !Grid::IsValidSize(rows, cols) || rows > GRID_TEXTURE_MAX_SIDE || cols > GRID_TEXTURE_MAX_SIDE)
+    {
+        fprintf(stderr, "Grid must be at least 2x2, at most %d cells and at most %d cells on a side\n", GRID_MAX_CELLS, GRID_TEXTURE_MAX_SIDE);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Initialization
+    int gridRows = 50;
+    int gridCols = 50;
+    float screenWidth = 1280;
+    float screenHeight = 720;
+
+    if (!ParseGridSize(argc, argv, gridRows, gridCols))
+    {
+        return 1;
+    }
+
+    ControlState state = {0, 0, false, 0, 0};
+
+    SetAlgorithmSeed(time(NULL));
+
+    // Algorithm currently running on its own thread. Mazes are carved into a copy of the grid,
+    // the displayed grid is only changed by draining the event ring
+    std::unique_ptr<Stepper> stepper;
+    std::thread worker;
+
+    // Set while the running stepper is a search, its path goes into the cache once it finishes
+    SearchStepper *searchStepper = NULL;
+    SearchType searchType = searchDepthFirst;
+    PathCache pathCache;
+    std::vector<int> cachedPath;
+    std::atomic<bool> workerDone(false);
+    Grid mazeGrid = {0};
+    EventRing events;
+    events.Reserve(EVENT_RING_CAPACITY);
+
+    // ID for gui elements
+    int id = 0;
+
+    InitWindow(screenWidth, screenHeight, "Pathfinding Visualizer");
+    SetWindowMinSize(screenWidth, screenHeight);
+    SetWindowState(FLAG_VSYNC_HINT | FLAG_WINDOW_ALWAYS_RUN | FLAG_WINDOW_RESIZABLE);
+
+    // Region for all of the buttons
+    Rectangle controlRegion = {0, 0, screenWidth / 5, screenHeight};
+    Rectangle gridBounds = {controlRegion.width, 0, screenWidth - controlRegion.width, screenHeight};
+    GridLayout gridLayout = FitGridLayout(gridBounds, gridRows, gridCols);
+
+    // Initialize button regions
+    Rectangle buttonRegions[4];
+    int buttonRegionArraySize = 4;
+
+    for (int i = 0; i < buttonRegionArraySize; i++)
+    {
+        buttonRegions[i] = CenterAndSizeGuiElement(controlRegion, buttonRegionArraySize, i, verticalFill);
+    }
+
+    // Initialize pathfinding buttons
+    SearchType pathfindingTypes[] = {searchDepthFirst, searchBreadthFirst, searchDijkstra, searchAStar, searchJumpPoint, searchJumpPointPlus};
+    const char *pathfindingButtonText[] = {"Depth First Search", "Breadth First Search", "Dijkstra's", "A*", "Jump Point Search", "JPS+", "HPA*", "D* Lite", "Flow Field"};
+    int pathfindingArraySize = 9;
+
+    // HPA*, D* Lite and the flow field have no search type, they are the buttons after the steppers
+    int hierarchicalButtonIndex = 6;
+    int replanButtonIndex = 7;
+    int flowFieldButtonIndex = 8;
+    Button pathfindingButtons[pathfindingArraySize];
+
+    for (int i = 0; i < pathfindingArraySize; i++)
+    {
+        pathfindingButtons[i] = {CenterAndSizeGuiElement(buttonRegions[0], pathfindingArraySize, i, verticalSpaced), pathfindingButtonText[i], buttonTypeText, LIGHTGRAY, id++};
+    }
+
+    // Initialize maze buttons
+    MazeType mazeTypes[] = {mazePrim, mazeDfs, mazeSidewinder};
+    const char *mazeButtonText[] = {"Randomized Prim's Maze", "Randomized DFS Maze", "Sidewinder Maze"};
+    int mazeArraySize = 3;
+    Button mazeButtons[mazeArraySize];
+
+    for (int i = 0; i < mazeArraySize; i++)
+    {
+        mazeButtons[i] = {CenterAndSizeGuiElement(buttonRegions[1], mazeArraySize, i, verticalSpaced), mazeButtonText[i], buttonTypeText, LIGHTGRAY, id++};
+    }
+
+    // Initialize cell buttons
+    enum CellTypes
+    {
+        emptyCell,
+        wallCell,
+        startCell,
+        endCell,
+        weightCell
+    };
+    Color cellButtonColors[] = {RAYWHITE, BEIGE, GREEN, RED, LIGHTGRAY};
+    const char *cellButtonText[] = {"Empty", "Wall", "Start", "End", "Weight"};
+    int cellArraySize = 5;
+    Button cellButtons[cellArraySize];
+
+    for (int i = 0; i < cellArraySize; i++)
+    {
+        cellButtons[i] = {CenterAndSizeGuiElement(buttonRegions[2], cellArraySize, i, gridSpaced), cellButtonText[i], buttonTypeImage, cellButtonColors[i], id++};
+    }
+
+    // Initialize control buttons
+    enum ControlTypes
+    {
+        visualize,
+        clear,
+        gridSizeControl,
+        directionControl
+    };
+    char gridSizeText[32];
+    snprintf(gridSizeText, sizeof(gridSizeText), "Grid: %dx%d", gridRows, gridCols);
+    char directionText[32];
+    UpdateDirectionText(directionText, sizeof(directionText), state.bidirectional);
+    const char *controlButtonText[] = {"Visualize", "Clear", gridSizeText, directionText};
+    Color controlButtonColors[] = {PURPLE, LIGHTGRAY, LIGHTGRAY, LIGHTGRAY};
+    int controlArraySize = 4;
+    Button controlButtons[controlArraySize];
+
+    for (int i = 0; i < controlArraySize; i++)
+    {
+        controlButtons[i] = {CenterAndSizeGuiElement(buttonRegions[3], controlArraySize + 1, i, verticalSpaced), controlButtonText[i], buttonTypeText, controlButtonColors[i], id++};
+    }
+
+    // Initialize speed slider below the control buttons
+    char speedText[32];
+    float speed = .3;
+    UpdateSpeedText(speedText, sizeof(speedText), speed);
+    Slider speedSlider = {CenterAndSizeGuiElement(buttonRegions[3], controlArraySize + 1, controlArraySize, verticalSpaced), speedText, speed, id++};
+
+    // Initialize grid
+    Grid grid = {0};
+    grid.Resize(gridRows, gridCols);
+    ResetStartAndEnd(state, grid);
+
+    GridRenderer renderer;
+    renderer.Load(gridRows, gridCols);
+
+    // Drawn over the grid after a flow field run until the grid or the end changes
+    FlowOverlay flowOverlay = {0};
+
+    // Built on the first HPA* or D* Lite run, later runs only repair what the brush touched
+    IncrementalSolvers solvers;
+
+    // Brush strokes only start on the grid and continue from the last painted cell
+    int brushRadius = 0;
+    bool painting = false;
+    int lastBrushX = 0;
+    int lastBrushY = 0;
+
+    // Render loop
+    while (!WindowShouldClose())
+    {
+        // Update GUI as window size changes
+        if (IsWindowResized())
+        {
+            screenHeight = GetScreenHeight();
+            screenWidth = GetScreenWidth();
+
+            // Update control region
+            controlRegion.height = screenHeight;
+            controlRegion.width = screenWidth / 5;
+
+            // Update grid region
+            gridBounds.x = controlRegion.width;
+            gridBounds.height = screenHeight;
+            gridBounds.width = screenWidth - controlRegion.width;
+            gridLayout = FitGridLayout(gridBounds, gridRows, gridCols);
+
+            // Update button regions
+            for (int i = 0; i < buttonRegionArraySize; i++)
+            {
+                buttonRegions[i] = CenterAndSizeGuiElement(controlRegion, buttonRegionArraySize, i, verticalFill);
+            }
+
+            // Update pathfinding buttons
+            for (int i = 0; i < pathfindingArraySize; i++)
+            {
+                pathfindingButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[0], pathfindingArraySize, i, verticalSpaced);
+            }
+
+            // Update maze buttons
+            for (int i = 0; i < mazeArraySize; i++)
+            {
+                mazeButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[1], mazeArraySize, i, verticalSpaced);
+            }
+
+            // Update cell buttons
+            for (int i = 0; i < cellArraySize; i++)
+            {
+                cellButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[2], cellArraySize, i, gridSpaced);
+            }
+
+            // Update control buttons
+            for (int i = 0; i < controlArraySize; i++)
+            {
+                controlButtons[i].bounds = CenterAndSizeGuiElement(buttonRegions[3], controlArraySize + 1, i, verticalSpaced);
+            }
+            speedSlider.bounds = CenterAndSizeGuiElement(buttonRegions[3], controlArraySize + 1, controlArraySize, verticalSpaced);
+        }
+
+        // Draw the progress of the running algorithm
+        if (stepper)
+        {
+            // Done is read first, the worker sets it after its last push
+            bool finished = workerDone.load(std::memory_order_acquire);
+
+            DrainEvents(events, grid, renderer, EventsPerFrame(speedSlider.value));
+
+            if (finished && events.IsEmpty())
+            {
+                worker.join();
+
+                if (searchStepper != NULL && searchStepper->finished)
+                {
+                    searchStepper->TracePath(cachedPath);
+                    pathCache.Insert(grid, searchStepper->startIndex, searchStepper->endIndex, searchType, searchStepper->result, &cachedPath);
+                }
+                searchStepper = NULL;
+
+                stepper.reset();
+                mazeGrid = {0};
+                GuiUnlock();
+            }
+        }
+
+        // Draw code
+        BeginDrawing();
+        ClearBackground(DARKGRAY);
+
+        // Grid input, the cell under the mouse comes straight from the grid layout
+        int hoverX = 0;
+        int hoverY = 0;
+        bool hovering = !GuiIsLocked() && gridLayout.CellAt(GetMousePosition(), hoverX, hoverY);
+
+        if (hovering)
+        {
+            // Mouse wheel sizes the brush
+            brushRadius += (int)GetMouseWheelMove();
+            brushRadius = brushRadius < 0 ? 0 : brushRadius > MAX_BRUSH_RADIUS ? MAX_BRUSH_RADIUS : brushRadius;
+
+            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+            {
+                painting = true;
+                lastBrushX = hoverX;
+                lastBrushY = hoverY;
+            }
+        }
+        if (GuiIsLocked() || IsMouseButtonUp(MOUSE_BUTTON_LEFT))
+        {
+            painting = false;
+        }
+
+        if (painting && hovering)
+        {
+            int index = grid.Index(hoverX, hoverY);
+
+            // Placing a start cell
+            if (state.cellButtonIndex == startCell)
+            {
+                // Start and end should not be the same cell
+                if (index != state.endCellIndex)
+                {
+                    renderer.MarkDirty(grid.X(state.startCellIndex), grid.Y(state.startCellIndex));
+                    renderer.MarkDirty(hoverX, hoverY);
+                    state.startCellIndex = index;
+                }
+            }
+            // Placing an end cell
+            else if (state.cellButtonIndex == endCell)
+            {
+                if (index != state.startCellIndex)
+                {
+                    renderer.MarkDirty(grid.X(state.endCellIndex), grid.Y(state.endCellIndex));
+                    renderer.MarkDirty(hoverX, hoverY);
+                    state.endCellIndex = index;
+                }
+            }
+            // Update the cells under the stroke to the current brush
+            else
+            {
+                PaintStroke(grid, renderer, solvers, lastBrushX, lastBrushY, hoverX, hoverY, brushRadius, state.cellButtonIndex == wallCell, state.cellButtonIndex == weightCell);
+            }
+
+            lastBrushX = hoverX;
+            lastBrushY = hoverY;
+        }
+
+        // Edits and a moved end leave the flow field pointing the wrong way
+        if (flowOverlay.visible && flowOverlay.IsStale(grid, state.endCellIndex))
+        {
+            flowOverlay.Hide();
+        }
+
+        // Draw grid
+        renderer.Update(grid, state.startCellIndex, state.endCellIndex);
+        renderer.Draw(gridLayout.Bounds());
+        flowOverlay.Draw(gridLayout.Bounds());
+
+        // Outline the cells the brush would paint
+        if (hovering)
+        {
+            int radius = state.cellButtonIndex == startCell || state.cellButtonIndex == endCell ? 0 : brushRadius;
+            DrawBrushOutline(gridLayout, grid, hoverX, hoverY, radius);
+        }
+
+        // Draw pathfinding buttons
+        for (int i = 0; i < pathfindingArraySize; i++)
+        {
+            if (pathfindingButtons[i].Draw())
+            {
+                state.pathfindingButtonIndex = i;
+            }
+            // Highlight selected button
+            if (state.pathfindingButtonIndex == i)
+            {
+                DrawRectangleLinesEx(pathfindingButtons[i].bounds, 2, BLUE);
+            }
+        }
+
+        // Draw maze buttons
+        for (int i = 0; i < mazeArraySize; i++)
+        {
+            if (mazeButtons[i].Draw())
+            {
+                // Fill the grid with walls
+                grid.Fill(true);
+                grid.ResetStates();
+                renderer.MarkAllDirty();
+                solvers.GridChanged();
+
+                mazeGrid = grid;
+
+                GuiLock();
+                events.Reset();
+                stepper = CreateMazeStepper(mazeTypes[i], mazeGrid, &events);
+                StartWorker(stepper.get(), events, workerDone, worker);
+            }
+        }
+
+        // Draw control buttons
+        for (int i = 0; i < controlArraySize; i++)
+        {
+            if (controlButtons[i].Draw())
+            {
+                switch (i)
+                {
+                case visualize:
+                {
+                    // Reset grid
+                    grid.ResetStates();
+                    renderer.MarkAllDirty();
+                    flowOverlay.Hide();
+
+                    if (state.pathfindingButtonIndex == hierarchicalButtonIndex)
+                    {
+                        ShowHierarchicalPath(solvers.hierarchy, grid, renderer, state.startCellIndex, state.endCellIndex);
+                        break;
+                    }
+                    if (state.pathfindingButtonIndex == replanButtonIndex)
+                    {
+                        ShowReplannedPath(solvers.planner, grid, renderer, state.startCellIndex, state.endCellIndex);
+                        break;
+                    }
+                    if (state.pathfindingButtonIndex == flowFieldButtonIndex)
+                    {
+                        ShowFlowField(flowOverlay, grid, renderer, state.startCellIndex, state.endCellIndex);
+                        break;
+                    }
+
+                    searchType = SelectedSearch(pathfindingTypes[state.pathfindingButtonIndex], state.bidirectional);
+
+                    SearchResult cachedResult;
+                    bool cached = pathCache.Find(grid, state.startCellIndex, state.endCellIndex, searchType, cachedResult, &cachedPath);
+                    UpdateCacheTitle(pathCache);
+                    if (cached)
+                    {
+                        ShowCachedPath(cachedPath, grid, renderer);
+                        break;
+                    }
+
+                    GuiLock();
+                    events.Reset();
+                    std::unique_ptr<SearchStepper> search;
+                    if (searchType == searchJumpPointPlus)
+                    {
+                        if (!solvers.jumpTable.Matches(grid))
+                        {
+                            solvers.jumpTable.Build(grid);
+                        }
+                        search = CreateJumpPointPlusStepper(solvers.jumpTable, grid, state.startCellIndex, state.endCellIndex, &events);
+                    }
+                    else
+                    {
+                        search = CreateSearchStepper(searchType, grid, state.startCellIndex, state.endCellIndex, queueAuto, &events);
+                    }
+                    searchStepper = search.get();
+                    stepper = std::move(search);
+                    StartWorker(stepper.get(), events, workerDone, worker);
+                    break;
+                }
+                case clear:
+                {
+                    grid.Fill(false);
+                    grid.ResetStates();
+                    renderer.MarkAllDirty();
+                    solvers.GridChanged();
+                    break;
+                }
+                case gridSizeControl:
+                {
+                    // Cycle to the next preset larger than the current grid
+                    int next = gridSizePresets[0];
+                    for (int i = 0; i < gridSizePresetCount; i++)
+                    {
+                        if (gridSizePresets[i] > gridRows || gridSizePresets[i] > gridCols)
+                        {
+                            next = gridSizePresets[i];
+                            break;
+                        }
+                    }
+                    if (next != gridRows || next != gridCols)
+                    {
+                        gridRows = next;
+                        gridCols = next;
+                        gridLayout = FitGridLayout(gridBounds, gridRows, gridCols);
+
+                        grid.Resize(gridRows, gridCols);
+                        ResetStartAndEnd(state, grid);
+                        renderer.Resize(gridRows, gridCols);
+                        solvers.GridChanged();
+                    }
+                    snprintf(gridSizeText, sizeof(gridSizeText), "Grid: %dx%d", gridRows, gridCols);
+                    break;
+                }
+                case directionControl:
+                {
+                    state.bidirectional = !state.bidirectional;
+                    UpdateDirectionText(directionText, sizeof(directionText), state.bidirectional);
+                    break;
+                }
+                }
+            }
+        }
+
+        // Draw cell buttons
+        for (int i = 0; i < cellArraySize; i++)
+        {
+            if (cellButtons[i].Draw())
+            {
+                state.cellButtonIndex = i;
+            }
+            if (state.cellButtonIndex == i)
+            {
+                DrawRectangleLinesEx(cellButtons[i].bounds, 2, BLUE);
+            }
+        }
+
+        // Draw speed slider
+        if (speedSlider.Draw())
+        {
+            UpdateSpeedText(speedText, sizeof(speedText), speedSlider.value);
+        }
+
+        DrawFPS(0, 0);
+        EndDrawing();
+    }
+
+    // De-Initialization
+    if (worker.joinable())
+    {
+        events.Cancel();
+        worker.join();
+    }
+    flowOverlay.Unload();
+    renderer.Unload();
+    CloseWindow();
+
+    return 0;
 }
\ No newline at end of file